@@ -7,7 +7,10 @@ Backend::base_alloc_t::~base_alloc_t()
 
 void
 Backend::base_alloc_t::copyHostToDev()
-{ copyHostToDevImpl(); }
+{
+    if (asyncCopied && *asyncCopied) syncHostToDevImpl();
+    copyHostToDevImpl();
+}
 
 void
 Backend::base_alloc_t::copyDevToHost()
@@ -23,8 +26,30 @@ Backend::base_alloc_t::free()
     byteSize = 0;
     read_only = true;
     associatedPtr = nullptr;
+    asyncCopied.reset();
+}
+
+void
+Backend::base_alloc_t::copyHostToDevAsync(size_t offset, size_t size)
+{
+    checkError(offset + size <= byteSize, "Asynchronous copy out of bounds! ",
+               "Offset: ", offset, " Size: ", size, " Max: ", byteSize);
+
+    if (copyHostToDevAsyncImpl(offset, size)) *asyncCopied += size;
 }
 
+void
+Backend::base_alloc_t::syncHostToDev()
+{ syncHostToDevImpl(); }
+
+bool
+Backend::base_alloc_t::copyHostToDevAsyncImpl(size_t, size_t)
+{ return false; }
+
+void
+Backend::base_alloc_t::syncHostToDevImpl()
+{}
+
 Backend::~Backend()
 {}
 
@@ -2,6 +2,7 @@
 #define BACKEND_HPP
 
 #include <cstddef>
+#include <memory>
 #include <vector>
 #include "utils/Util.hpp"
 
@@ -14,11 +15,13 @@ class Backend {
         size_t byteSize;
         bool read_only;
         void **associatedPtr;
+        std::shared_ptr<size_t> asyncCopied;
 
         base_alloc_t() {}
 
         base_alloc_t(std::shared_ptr<void> p, size_t N, bool ro, void** assoc)
          : hostPtr(p), byteSize(N), read_only(ro), associatedPtr(assoc)
+         , asyncCopied(std::make_shared<size_t>(0))
         {}
 
         base_alloc_t(std::shared_ptr<void> p, size_t N, bool readonly)
@@ -27,18 +30,32 @@ class Backend {
 
         base_alloc_t(const base_alloc_t& o)
          : hostPtr(o.hostPtr), byteSize(o.byteSize), read_only(o.read_only)
-         , associatedPtr(o.associatedPtr)
+         , associatedPtr(o.associatedPtr), asyncCopied(o.asyncCopied)
         {}
 
         virtual void copyHostToDevImpl() = 0;
         virtual void copyDevToHostImpl() = 0;
         virtual void freeImpl() = 0;
 
+        /* Backends without asynchronous copies return false, in which case
+         * copyHostToDev() transfers the whole buffer as usual. Otherwise
+         * copyHostToDev() calls syncHostToDevImpl() before
+         * copyHostToDevImpl(), so the latter can skip ranges that were
+         * already copied.
+         */
+        virtual bool copyHostToDevAsyncImpl(size_t offset, size_t size);
+        virtual void syncHostToDevImpl();
+
+        /* True if asynchronous copies have covered the entire buffer. */
+        bool asyncComplete() const
+        { return asyncCopied && *asyncCopied >= byteSize; }
+
       public:
         base_alloc_t(base_alloc_t&& o)
          : hostPtr(std::move(o.hostPtr)), byteSize(o.byteSize)
          , read_only(o.read_only)
          , associatedPtr(o.associatedPtr)
+         , asyncCopied(std::move(o.asyncCopied))
         {
             o.byteSize = 0;
             o.associatedPtr = nullptr;
@@ -51,6 +68,13 @@ class Backend {
         void copyDevToHost();
         void free();
 
+        /* Starts copying bytes [offset, offset + size) of the host buffer to
+         * the device without waiting for completion. The host data in that
+         * range must not change until syncHostToDev() or copyHostToDev().
+         */
+        void copyHostToDevAsync(size_t offset, size_t size);
+        void syncHostToDev();
+
         base_alloc_t& operator=(base_alloc_t&& other)
         {
             hostPtr = std::move(other.hostPtr);
@@ -63,6 +87,8 @@ class Backend {
             associatedPtr = other.associatedPtr;
             other.associatedPtr = nullptr;
 
+            asyncCopied = std::move(other.asyncCopied);
+
             return *this;
         }
     };
@@ -197,6 +223,10 @@ class Backend {
          : Base(sz, readonly), max(N), size(max)
         {}
 
+        typed_alloc_t(size_t N, Base&& base)
+         : Base(std::move(base)), max(N), size(max)
+        {}
+
         typed_alloc_t(typed_alloc_t&& o)
          : Base(std::move(o)), max(o.max), size(max)
         { o.max = 0; }
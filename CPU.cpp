@@ -0,0 +1,287 @@
+#include <algorithm>
+
+#include "CPU.hpp"
+
+#define CEIL_DIV(x, y)          (((x) + ((y) - 1)) / (y))
+
+using std::cerr;
+using std::cout;
+using std::endl;
+
+CPUBackend::cpu_alloc_t::~cpu_alloc_t()
+{}
+
+thread_local CPUBackend::block_context CPUBackend::currentBlock = { 0, 1, 1 };
+
+CPUBackend& CPU = CPUBackend::get();
+
+CPUBackend& CPUBackend::get()
+{
+    static CPUBackend cpu;
+    return cpu;
+}
+
+CPUBackend::CPUBackend()
+ : blockSize(1), gridSize(1), currentTask(nullptr), generation(0)
+ , busyWorkers(0), shutdown(false)
+{
+    devicesPerPlatform_.push_back(1);
+    maxDims_ = 3;
+    initialised_ = true;
+}
+
+CPUBackend::~CPUBackend()
+{ stopWorkers(); }
+
+std::pair<uint64_t,uint64_t> CPUBackend::blockRange(uint64_t count)
+{
+    uint64_t chunk = CEIL_DIV(count, currentBlock.gridDim);
+    uint64_t start = std::min(count, currentBlock.blockIdx * chunk);
+    return { start, std::min(count, start + chunk) };
+}
+
+void CPUBackend::queryPlatform(size_t platform, bool verbose)
+{
+    if (platform >= devicesPerPlatform.size()) {
+        cerr << "Non-existent platform #"
+             << platform
+             << ", platform count is "
+             << devicesPerPlatform.size()
+             << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    cout << "Platform #" << platform << ":" << endl;
+
+    listDevices(platform, verbose);
+}
+
+void CPUBackend::queryDevice(size_t platform, int dev, bool verbose)
+{
+    if (platform >= devicesPerPlatform.size()) {
+        cerr << "Non-existent platform #"
+             << platform
+             << ", platform count is "
+             << devicesPerPlatform.size()
+             << endl;
+        exit(EXIT_FAILURE);
+    } else if (dev >= devicesPerPlatform[platform]) {
+        cerr << "Non-existent device #"
+             << dev
+             << ", device count for platform "
+             << platform
+             << " is "
+             << devicesPerPlatform[platform]
+             << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    cout << "    Device Number: " << dev << endl;
+    cout << "\tDevice Name: host" << endl;
+
+    cout << endl;
+
+    if (!verbose) return;
+
+    cout << "\tHardware Threads: "
+         << std::thread::hardware_concurrency() << endl;
+
+    cout << endl;
+}
+
+void CPUBackend::setDevice(size_t platform, int device)
+{
+    if (platform >= devicesPerPlatform.size()) {
+        cerr << "Non-existent platform #"
+             << platform
+             << ", platform count is "
+             << devicesPerPlatform.size()
+             << endl;
+        exit(EXIT_FAILURE);
+    } else if (device >= devicesPerPlatform[platform]) {
+        cerr << "Non-existent device #"
+             << device
+             << ", device count for platform "
+             << platform
+             << " is "
+             << devicesPerPlatform[platform]
+             << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    numComputeUnits_ = std::max(1U, std::thread::hardware_concurrency());
+    maxThreadsPerBlock_ = 1024;
+    /* No shared memory, so warp-based kernels are rejected. */
+    maxSharedMem_ = 0;
+    maxBlockSizes_ = { maxThreadsPerBlock_, maxThreadsPerBlock_, 64 };
+    maxGridSizes_ = { 2147483647, 65535, 65535 };
+
+    startWorkers();
+}
+
+void CPUBackend::setWorkSizes
+( size_t dims
+, std::vector<size_t> blockSizes
+, std::vector<size_t> gridSizes
+, size_t sharedMem)
+{
+    if (dims < 1 || dims > 3) {
+        cerr << "Invalid number of dimensions: " << dims << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (sharedMem > maxSharedMem) {
+        cerr << "Insufficient shared memory, " << sharedMem << " request, "
+             << maxSharedMem << " available." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (blockSizes.size() != dims) {
+        cerr << "Number of block sizes ("
+             << blockSizes.size()
+             << ") don't match specified number of dimensions ("
+             << dims
+             << ")"
+             << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (gridSizes.size() != dims) {
+        cerr << "Number of grid sizes ("
+             << gridSizes.size()
+             << ") don't match specified number of dimensions ("
+             << dims
+             << ")"
+             << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    blockSize = 1;
+    for (auto size : blockSizes) blockSize *= size;
+
+    gridSize = 1;
+    for (auto size : gridSizes) gridSize *= size;
+}
+
+void CPUBackend::startWorkers()
+{
+    if (!queues.empty()) return;
+
+    for (size_t i = 0; i < numComputeUnits; i++) {
+        queues.emplace_back(new block_queue());
+    }
+
+    /* The launching thread acts as worker 0. */
+    for (size_t i = 1; i < numComputeUnits; i++) {
+        workers.emplace_back(&CPUBackend::workerLoop, this, i);
+    }
+}
+
+void CPUBackend::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> guard(poolLock);
+        shutdown = true;
+    }
+    wakeup.notify_all();
+
+    for (auto& worker : workers) worker.join();
+    workers.clear();
+}
+
+void CPUBackend::workerLoop(size_t id)
+{
+    size_t seen = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> guard(poolLock);
+            wakeup.wait(guard, [&]() {
+                return shutdown || generation != seen;
+            });
+
+            if (shutdown) return;
+            seen = generation;
+        }
+
+        runWorker(id);
+
+        {
+            std::lock_guard<std::mutex> guard(poolLock);
+            if (--busyWorkers == 0) finished.notify_one();
+        }
+    }
+}
+
+void CPUBackend::runWorker(size_t id)
+{
+    size_t block;
+
+    while (nextBlock(id, block)) {
+        currentBlock = { block, blockSize, gridSize };
+        (*currentTask)();
+    }
+}
+
+bool CPUBackend::nextBlock(size_t id, size_t& block)
+{
+    block_queue& own = *queues[id];
+    {
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (own.begin < own.end) {
+            block = own.begin++;
+            return true;
+        }
+    }
+
+    /* Own range exhausted, steal the back half of another worker's range. */
+    for (size_t i = 1; i < queues.size(); i++) {
+        block_queue& victim = *queues[(id + i) % queues.size()];
+        size_t begin, end;
+        {
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (victim.begin >= victim.end) continue;
+
+            end = victim.end;
+            begin = end - CEIL_DIV(end - victim.begin, 2);
+            victim.end = begin;
+        }
+
+        std::lock_guard<std::mutex> guard(own.lock);
+        block = begin;
+        own.begin = begin + 1;
+        own.end = end;
+        return true;
+    }
+
+    return false;
+}
+
+void CPUBackend::runBlocks(const std::function<void()>& task)
+{
+    if (queues.empty()) {
+        cerr << "No device selected for CPU backend!" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    size_t perWorker = CEIL_DIV(gridSize, queues.size());
+    for (size_t i = 0; i < queues.size(); i++) {
+        std::lock_guard<std::mutex> guard(queues[i]->lock);
+        queues[i]->begin = std::min(gridSize, i * perWorker);
+        queues[i]->end = std::min(gridSize, (i + 1) * perWorker);
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(poolLock);
+        currentTask = &task;
+        busyWorkers = workers.size();
+        generation++;
+    }
+    wakeup.notify_all();
+
+    runWorker(0);
+
+    std::unique_lock<std::mutex> guard(poolLock);
+    finished.wait(guard, [this]() { return busyWorkers == 0; });
+    currentTask = nullptr;
+}
@@ -0,0 +1,287 @@
+#ifndef CPU_HPP
+#define CPU_HPP
+
+#include <condition_variable>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Backend.hpp"
+#include "utils/Util.hpp"
+
+class CPUBackend;
+
+extern CPUBackend& CPU;
+
+class CPUBackend : public Backend {
+    friend class Backend;
+
+    class cpu_alloc_t : public base_alloc_t
+    {
+        static std::shared_ptr<void>
+        allocHostPtr(size_t sz)
+        {
+            return std::shared_ptr<void>(new char[sz], [](void *p) {
+                delete[] static_cast<char*>(p);
+            });
+        }
+
+      protected:
+        std::vector<cpu_alloc_t> localAllocs;
+
+        void copyHostToDevImpl() final override
+        {
+            for (auto alloc : localAllocs) alloc.copyHostToDev();
+            if (associatedPtr) *associatedPtr = hostPtr.get();
+        }
+
+        void copyDevToHostImpl() final override
+        { for (auto alloc : localAllocs) alloc.copyDevToHost(); }
+
+        /* Host memory is device memory, nothing to copy. */
+        bool copyHostToDevAsyncImpl(size_t, size_t) final override
+        { return true; }
+
+        void freeImpl() final override
+        { localAllocs.clear(); }
+
+        void registerAlloc(const cpu_alloc_t& val, void** ptr)
+        {
+            localAllocs.emplace_back(val);
+            localAllocs.back().associatedPtr = ptr;
+            *ptr = val.hostPtr.get();
+        }
+
+      public:
+        cpu_alloc_t()
+        {}
+
+        cpu_alloc_t(size_t size, bool readonly)
+         : base_alloc_t(allocHostPtr(size), size, readonly)
+        {}
+
+        cpu_alloc_t(std::shared_ptr<void> ptr, size_t size, bool readonly)
+         : base_alloc_t(ptr, size, readonly)
+        {}
+
+        cpu_alloc_t(const cpu_alloc_t& o)
+         : base_alloc_t(o), localAllocs(o.localAllocs)
+        {}
+
+        cpu_alloc_t(cpu_alloc_t&& o)
+         : base_alloc_t(std::move(o)), localAllocs(std::move(o.localAllocs))
+        {}
+
+        ~cpu_alloc_t() override;
+
+        cpu_alloc_t& operator=(cpu_alloc_t&& other)
+        {
+            base_alloc_t::operator=(std::move(other));
+            localAllocs = std::move(other.localAllocs);
+            return *this;
+        }
+
+        void registerLocalAlloc(void *ptr, const cpu_alloc_t& val)
+        { registerAlloc(val, static_cast<void**>(ptr)); }
+    };
+
+  public:
+    template<typename V>
+    class alloc_t : public typed_alloc_t<V, cpu_alloc_t>
+    {
+        friend CPUBackend;
+
+      public:
+        alloc_t() {}
+
+        alloc_t(alloc_t&& o) : typed_alloc_t<V,cpu_alloc_t>(std::move(o))
+        {}
+
+        alloc_t(size_t N, bool ro)
+            : typed_alloc_t<V,cpu_alloc_t>(N, sizeof(V) * N, ro)
+        {}
+
+        alloc_t(std::shared_ptr<void> ptr, size_t N, bool ro)
+            : typed_alloc_t<V,cpu_alloc_t>(N, cpu_alloc_t(ptr, sizeof(V) * N, ro))
+        {}
+
+        alloc_t& operator=(alloc_t&& o)
+        {
+            typed_alloc_t<V, cpu_alloc_t>::operator=(std::move(o));
+            return *this;
+        }
+
+        template<typename T>
+        void allocLocal(T * __restrict__ *loc, size_t N)
+        { allocLocal(const_cast<T**>(loc), N); }
+
+        template<typename T>
+        void allocLocal(T **ptr, size_t N)
+        { this->registerLocalAlloc(static_cast<void*>(ptr), alloc_t<T>(N, false)); }
+    };
+
+  private:
+    struct block_queue {
+        std::mutex lock;
+        size_t begin;
+        size_t end;
+
+        block_queue() : begin(0), end(0) {}
+    };
+
+    struct block_context {
+        size_t blockIdx;
+        size_t blockDim;
+        size_t gridDim;
+    };
+
+    static thread_local block_context currentBlock;
+
+    template<typename V>
+    static V*
+    devicePtr(const alloc_t<V>& val)
+    { return static_cast<V*>(val.hostPtr.get()); }
+
+    template
+    < typename T
+    , typename = typename std::enable_if<std::is_fundamental<T>::value>::type
+    >
+    static const T&
+    devicePtr(const T& val)
+    { return val; }
+
+    CPUBackend();
+    ~CPUBackend() override;
+
+    void startWorkers();
+    void stopWorkers();
+    void workerLoop(size_t id);
+    void runWorker(size_t id);
+    bool nextBlock(size_t id, size_t& block);
+    void runBlocks(const std::function<void()>& task);
+
+  public:
+    typedef void* kernel_type;
+
+    template<typename T>
+    struct HostToDev { typedef T type; };
+
+    template<typename T>
+    struct HostToDev<alloc_t<T>> { typedef T* type; };
+
+    template<typename T>
+    struct HostToDev<alloc_t<T>&> { typedef T* type; };
+
+    template<typename T>
+    struct HostToDev<alloc_t<T>&&> { typedef T* type; };
+
+    template<typename T>
+    struct DevToHost { typedef T type; };
+
+    template<typename T>
+    struct DevToHost<T*> { typedef alloc_t<T> type; };
+
+    template<typename... Args>
+    struct kernel {
+        using type = void (*)(typename HostToDev<Args>::type...);
+    };
+
+    static CPUBackend& get();
+
+    /* Contiguous slice of [0, count) owned by the currently executing block,
+     * CPU kernels iterate over this instead of a grid-stride loop.
+     */
+    static std::pair<uint64_t,uint64_t> blockRange(uint64_t count);
+
+    template<typename T>
+    static T
+    atomicLoad(const T *addr)
+    {
+        T result;
+        __atomic_load(addr, &result, __ATOMIC_RELAXED);
+        return result;
+    }
+
+    template<typename T>
+    static T
+    atomicMin(T *addr, T val)
+    {
+        T old = atomicLoad(addr);
+        while (val < old && !__atomic_compare_exchange(addr, &old, &val, true,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+        return old;
+    }
+
+    template<typename T>
+    static T
+    atomicAdd(T *addr, T val)
+    {
+        T old = atomicLoad(addr);
+        T result;
+        do {
+            result = old + val;
+        } while (!__atomic_compare_exchange(addr, &old, &result, true,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+        return old;
+    }
+
+    void queryPlatform(size_t platform, bool verbose) override;
+    void queryDevice(size_t platform, int device, bool verbose) override;
+    void setDevice(size_t platform, int device) override;
+    void setWorkSizes(size_t dims, std::vector<size_t> blockSizes,
+                        std::vector<size_t> gridSizes,
+                        size_t sharedMem = 0) override;
+
+    template<typename... Args>
+    void
+    runKernel(typename kernel<Args...>::type kernel, const Args&... args)
+    { runBlocks([&]() { kernel(devicePtr(args)...); }); }
+
+    template<typename V>
+    alloc_t<V> alloc()
+    { return alloc<V>(1); }
+
+    template<typename V>
+    alloc_t<V> alloc(size_t count)
+    { return alloc_t<V>(count, false); }
+
+    template<typename V>
+    alloc_t<V> allocConstant()
+    { return allocConstant<V>(1); }
+
+    template<typename V>
+    alloc_t<V> allocConstant(size_t count)
+    { return alloc_t<V>(count, true); }
+
+    /* Host memory is device memory, so existing read-only data (e.g. a
+     * mmapped graph file) can be used by kernels as is.
+     */
+    template<typename V>
+    alloc_t<V> mapConstant(std::shared_ptr<void> data, size_t count)
+    { return alloc_t<V>(data, count, true); }
+
+  private:
+    size_t blockSize;
+    size_t gridSize;
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<block_queue>> queues;
+
+    std::mutex poolLock;
+    std::condition_variable wakeup;
+    std::condition_variable finished;
+    const std::function<void()> *currentTask;
+    size_t generation;
+    size_t busyWorkers;
+    bool shutdown;
+};
+
+template<typename T>
+struct isBackendAllocTrait<CPUBackend::alloc_t<T>> : public std::true_type
+{};
+#endif
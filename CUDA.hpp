@@ -67,12 +67,13 @@ class CUDABackend : public Backend {
 
         void copyHostToDevImpl() final override
         {
-            CUDA_CHK(cudaDeviceSynchronize());
             if (!managed) {
                 for (auto alloc : localAllocs) alloc.copyHostToDev();
 
-                CUDA_CHK(cudaMemcpy(devPtr.get(), hostPtr.get(), byteSize ,
-                                    cudaMemcpyHostToDevice));
+                if (!asyncComplete()) {
+                    CUDA_CHK(cudaMemcpy(devPtr.get(), hostPtr.get(), byteSize,
+                                        cudaMemcpyHostToDevice));
+                }
 
                 if (associatedPtr) *associatedPtr = devPtr.get();
             }
@@ -89,6 +90,20 @@ class CUDABackend : public Backend {
             }
         }
 
+        bool copyHostToDevAsyncImpl(size_t offset, size_t size) final override
+        {
+            if (!managed) {
+                auto dst = static_cast<char*>(devPtr.get()) + offset;
+                auto src = static_cast<char*>(hostPtr.get()) + offset;
+                CUDA_CHK(cudaMemcpyAsync(dst, src, size, cudaMemcpyHostToDevice,
+                                         cudaStreamPerThread));
+            }
+            return true;
+        }
+
+        void syncHostToDevImpl() final override
+        { CUDA_CHK(cudaStreamSynchronize(cudaStreamPerThread)); }
+
         void freeImpl() final override
         {
             CUDA_CHK(cudaDeviceSynchronize());
@@ -0,0 +1,169 @@
+#ifndef DECISIONTREE_HPP
+#define DECISIONTREE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "utils/Util.hpp"
+
+// Decision tree predictor loaded from a tree file exported by
+// benchmark-analysis' "Model export-tree", as an alternative to dlopen()ing
+// a compiled model. Nodes are kept as structure of arrays, leaves have
+// feature -1 and their implementation as right child. Properties are read
+// from a dense vector indexed by the property's model index.
+class DecisionTree {
+  public:
+    struct Implementation {
+        std::string name;
+        int64_t id;
+        size_t idx, warp, chunk;
+    };
+
+    static constexpr const char *magic = "belewitte-tree";
+
+    std::string name;
+    int32_t defaultImpl;
+    std::vector<std::pair<std::string,size_t>> propertyNames;
+    std::vector<Implementation> implementations;
+    std::vector<double> properties;
+
+    DecisionTree() : defaultImpl(-1)
+    {}
+
+    // Whether fileName looks like a tree file, rather than a shared library.
+    static bool isTreeFile(const std::string& fileName)
+    {
+        std::ifstream input(fileName);
+        std::string header;
+        return input >> header && header == magic;
+    }
+
+    void load(const std::string& fileName)
+    {
+        std::ifstream input(fileName);
+        if (!input) reportError("Failed to open model: ", fileName);
+
+        std::string line, keyword;
+        int version;
+        if (!std::getline(input, line)
+            || !(std::istringstream(line) >> keyword >> version)
+            || keyword != magic || version != 1) {
+            reportError("Not a version 1 decision tree: ", fileName);
+        }
+
+        size_t maxProp = 0;
+        for (size_t lineNum = 2; std::getline(input, line); lineNum++) {
+            std::istringstream fields(line);
+            if (!(fields >> keyword)) continue;
+
+            bool valid = true;
+            if (keyword == "name") {
+                valid = static_cast<bool>(fields >> std::ws);
+                std::getline(fields, name);
+            } else if (keyword == "default") {
+                valid = static_cast<bool>(fields >> defaultImpl);
+            } else if (keyword == "property") {
+                size_t idx;
+                std::string propName;
+                valid = fields >> idx >> std::ws && std::getline(fields, propName);
+                if (valid) {
+                    propertyNames.emplace_back(propName, idx);
+                    maxProp = std::max(maxProp, idx + 1);
+                }
+            } else if (keyword == "implementation") {
+                Implementation impl;
+                valid = fields >> impl.idx >> impl.id >> impl.warp >> impl.chunk
+                            >> std::ws
+                     && std::getline(fields, impl.name);
+                if (valid) implementations.push_back(impl);
+            } else if (keyword == "node") {
+                std::string thresholdStr;
+                int32_t prop, left, right;
+                valid = static_cast<bool>(fields >> thresholdStr >> prop >> left >> right);
+                if (valid) {
+                    double threshold = std::strtod(thresholdStr.c_str(), nullptr);
+                    addNode(threshold, prop, left, right);
+                }
+            } else {
+                valid = false;
+            }
+
+            if (!valid) {
+                reportError("Malformed line ", lineNum, " in model: ", fileName);
+            }
+        }
+
+        properties.assign(maxProp, 0.0);
+        validate(fileName);
+    }
+
+    int32_t lookup() const
+    {
+        const double *props = properties.data();
+        size_t node = 0;
+        for (int32_t feature; (feature = features[node]) >= 0;) {
+            bool right = !(props[static_cast<size_t>(feature)] <= thresholds[node]);
+            node = static_cast<size_t>(children[2 * node + right]);
+        }
+        return children[2 * node + 1];
+    }
+
+    // Property index and threshold of every split node.
+    std::vector<std::pair<size_t,double>> splits() const
+    {
+        std::vector<std::pair<size_t,double>> result;
+        for (size_t n = 0; n < features.size(); n++) {
+            if (features[n] < 0) continue;
+            result.emplace_back(static_cast<size_t>(features[n]), thresholds[n]);
+        }
+        return result;
+    }
+
+  private:
+    std::vector<double> thresholds;
+    std::vector<int32_t> features;
+    std::vector<int32_t> children;
+
+    void addNode(double threshold, int32_t prop, int32_t left, int32_t right)
+    {
+        bool leaf = left == -1;
+        thresholds.push_back(threshold);
+        features.push_back(leaf ? -1 : prop);
+        children.push_back(left);
+        children.push_back(right);
+    }
+
+    void validate(const std::string& fileName)
+    {
+        auto nodes = static_cast<int32_t>(features.size());
+        if (!nodes) reportError("Empty decision tree: ", fileName);
+
+        auto impls = static_cast<int32_t>(implementations.size());
+        for (int32_t n = 0; n < nodes; n++) {
+            auto idx = static_cast<size_t>(n);
+            auto feature = features[idx];
+            auto left = children[2 * idx];
+            auto right = children[2 * idx + 1];
+
+            if (feature < 0) {
+                if (right < -1 || right >= impls) {
+                    reportError("Invalid implementation in model: ", fileName);
+                }
+            } else if (static_cast<size_t>(feature) >= properties.size()
+                    || left <= n || left >= nodes
+                    || right <= n || right >= nodes) {
+                reportError("Invalid node ", n, " in model: ", fileName);
+            }
+        }
+
+        if (defaultImpl < 0 || defaultImpl >= impls) {
+            reportError("Invalid default implementation in model: ", fileName);
+        }
+    }
+};
+#endif
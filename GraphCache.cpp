@@ -0,0 +1,103 @@
+#include <sys/stat.h>
+
+#include "GraphCache.hpp"
+
+GraphCache::GraphCache() : budget(0)
+{}
+
+GraphCache& GraphCache::get()
+{
+    static GraphCache cache;
+    return cache;
+}
+
+void GraphCache::setBudget(size_t bytes)
+{
+    budget = bytes;
+    if (!enabled()) clear();
+}
+
+void GraphCache::clear()
+{ entries.clear(); }
+
+std::shared_ptr<void>
+GraphCache::lookup(const std::string& file, const std::type_info& type)
+{
+    if (!enabled()) return nullptr;
+
+    struct stat statbuf;
+    bool exists = stat(file.c_str(), &statbuf) == 0;
+
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->file != file || it->type != type.name()) continue;
+
+        if (!exists || it->mtime != modification_time(statbuf)
+                    || it->fileSize != statbuf.st_size) {
+            entries.erase(it);
+            return nullptr;
+        }
+
+        entries.splice(entries.begin(), entries, it);
+        return it->data;
+    }
+
+    return nullptr;
+}
+
+void
+GraphCache::store
+( const std::string& file
+, const std::type_info& type
+, std::shared_ptr<void> data
+, size_t bytes)
+{
+    if (!enabled()) return;
+
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->file == file && it->type == type.name()) {
+            entries.erase(it);
+            break;
+        }
+    }
+
+    struct stat statbuf;
+    if (bytes > budget || stat(file.c_str(), &statbuf) != 0) return;
+
+    entries.push_front({file, type.name(), modification_time(statbuf),
+                        statbuf.st_size, data, bytes});
+
+    size_t total = 0;
+    for (auto& entry : entries) total += entry.bytes;
+
+    while (total > budget) {
+        total -= entries.back().bytes;
+        entries.pop_back();
+    }
+}
+
+void
+GraphCache::reserve
+( const std::string& file
+, const std::type_info& type
+, size_t needed)
+{
+    if (!enabled()) return;
+
+    auto isOther = [&](const Entry& entry) {
+        return entry.file != file || entry.type != type.name();
+    };
+
+    size_t total = 0;
+    for (auto& entry : entries) {
+        if (isOther(entry)) total += entry.bytes;
+    }
+
+    for (auto it = entries.end(); total + needed > budget
+                               && it != entries.begin();) {
+        --it;
+        if (isOther(*it)) {
+            total -= it->bytes;
+            it = entries.erase(it);
+        }
+    }
+}
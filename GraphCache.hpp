@@ -0,0 +1,77 @@
+#ifndef GRAPHCACHE_HPP
+#define GRAPHCACHE_HPP
+
+#include <cstddef>
+#include <ctime>
+#include <list>
+#include <memory>
+#include <string>
+#include <typeinfo>
+
+#include <sys/types.h>
+
+#include "utils/Util.hpp"
+
+/* Keeps loaded graphs (including their device allocations) alive between
+ * jobs, so consecutive jobs on the same graph load and transfer it only once.
+ * Entries are keyed on the graph file, its modification time and size, and
+ * the type of the loader data, and are evicted in least recently used order
+ * once their combined size exceeds the budget. Before loading a graph,
+ * reserve() evicts entries to make room for its resident size, so the cache
+ * and the new graph together stay within the budget. A budget of 0 disables
+ * it.
+ */
+class GraphCache
+{
+    struct Entry {
+        std::string file;
+        std::string type;
+        struct timespec mtime;
+        off_t fileSize;
+        std::shared_ptr<void> data;
+        size_t bytes;
+    };
+
+    std::list<Entry> entries;
+    size_t budget;
+
+    GraphCache();
+    GraphCache(const GraphCache&) = delete;
+    void operator=(const GraphCache&) = delete;
+
+    std::shared_ptr<void>
+    lookup(const std::string& file, const std::type_info& type);
+
+    void
+    store(const std::string& file, const std::type_info& type,
+          std::shared_ptr<void> data, size_t bytes);
+
+    void reserve(const std::string& file, const std::type_info& type,
+                 size_t bytes);
+
+  public:
+    static GraphCache& get();
+
+    bool enabled() const
+    { return budget != 0; }
+
+    void setBudget(size_t bytes);
+    void clear();
+
+    template<typename T>
+    std::shared_ptr<T>
+    lookup(const std::string& file)
+    { return std::static_pointer_cast<T>(lookup(file, typeid(T))); }
+
+    /* Evicts other entries until bytes for the file fit in the budget. */
+    template<typename T>
+    void
+    reserve(const std::string& file, size_t bytes)
+    { reserve(file, typeid(T), bytes); }
+
+    template<typename T>
+    void
+    store(const std::string& file, std::shared_ptr<T> data, size_t bytes)
+    { store(file, typeid(T), data, bytes); }
+};
+#endif
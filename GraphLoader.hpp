@@ -1,8 +1,16 @@
 #ifndef GRAPHLOADER_HPP
 #define GRAPHLOADER_HPP
 
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
 #include "utils/Graph.hpp"
 #include "Backend.hpp"
+#include "GraphCache.hpp"
 #include "GraphRep.hpp"
 
 enum class Rep : char
@@ -24,6 +32,9 @@ struct GraphRep
     Dir direction;
 };
 
+inline bool operator==(const GraphRep& a, const GraphRep& b)
+{ return a.representation == b.representation && a.direction == b.direction; }
+
 inline std::ostream& operator<<(std::ostream& os, const Rep& p)
 {
     switch (p) {
@@ -112,47 +123,320 @@ class GraphLoader
         }
     }
 
+    static uint32_t repBit(Rep rep, Dir dir)
+    { return 1U << (2 * static_cast<int>(rep) + static_cast<int>(dir)); }
+
+    template<typename P, typename = void>
+    struct canMapConstant : std::false_type {};
+
+    template<typename P>
+    struct canMapConstant<P, std::void_t<decltype(std::declval<P&>()
+            .template mapConstant<char>(std::shared_ptr<void>(), 0))>>
+      : std::true_type {};
+
+    /* Builds the device representations on demand from the graph file. Only
+     * the arrays required by the requested representations are materialised,
+     * and on backends that can use host memory directly, arrays whose on-disk
+     * width matches are shared with the mmapped file instead of copied.
+     */
     class RawData {
+        static constexpr size_t minEdgesPerThread = 1 << 20;
+        static constexpr size_t chunkEdges = 1 << 24;
+
         Platform& p;
+        const Graph<V,E> *graph;
 
         pair<alloc_t<V>> vertices;
         pair<alloc_t<struct edge<E>>> struct_edges;
         pair<alloc_t<E>> in_edges;
         pair<alloc_t<E>> out_edges;
 
-        template<int n>
+        /* Undirected graphs store only one direction on disk, so the reverse
+         * arrays are identical to the forward ones and can be shared.
+         */
+        Dir source(Dir dir) const
+        {
+            if (graph->raw_rev_vertices == graph->raw_vertices
+                && graph->raw_rev_edges == graph->raw_edges) {
+                return Dir::Forward;
+            }
+            return dir;
+        }
+
+        const Accessor<V>& rawVertices(Dir dir) const
+        {
+            if (dir == Dir::Forward) return graph->raw_vertices;
+            return graph->raw_rev_vertices;
+        }
+
+        const Accessor<E>& rawEdges(Dir dir) const
+        {
+            if (dir == Dir::Forward) return graph->raw_edges;
+            return graph->raw_rev_edges;
+        }
+
+        template<typename T>
+        bool mappable(const Accessor<T>& raw) const
+        {
+            if constexpr (canMapConstant<Platform>::value) {
+                return std::is_unsigned<T>::value && raw.valueSize == sizeof(T);
+            }
+            return false;
+        }
+
+        template<typename T>
+        void mapOrAlloc(alloc_t<T>& dest, const Accessor<T>& raw, size_t count)
+        {
+            if constexpr (canMapConstant<Platform>::value) {
+                if (mappable(raw)) {
+                    dest = p.template mapConstant<T>(raw.storage(), count);
+                    return;
+                }
+            }
+            dest = p.template allocConstant<T>(count);
+            bytes += count * sizeof(T);
+        }
+
+        template<typename T>
+        void release(alloc_t<T>& dest, size_t count, bool mapped)
+        {
+            if (!dest) return;
+            if (!mapped) bytes -= count * sizeof(T);
+            dest = alloc_t<T>();
+        }
+
+        /* Splits the vertices in [first, last) into ranges containing roughly
+         * equal numbers of edges and calls f(begin, end) for each range on its
+         * own thread.
+         */
+        template<typename SrcV, typename F>
+        void
+        parallelVertices(const SrcV *offsets, size_t first, size_t last, F& f)
+        {
+            size_t edges = offsets[last] - offsets[first];
+            size_t threads = std::max(1U, std::thread::hardware_concurrency());
+            threads = std::min(threads, 1 + edges / minEdgesPerThread);
+
+            std::vector<size_t> bounds{first};
+            for (size_t t = 1; t < threads; t++) {
+                size_t split = offsets[first] + (edges * t) / threads;
+                auto it = std::upper_bound(offsets + bounds.back(),
+                                           offsets + last, split);
+                bounds.push_back(static_cast<size_t>(it - offsets));
+            }
+            bounds.push_back(last);
+
+            parallel_blocks(threads, [&](uint64_t t) {
+                if (bounds[t] < bounds[t + 1]) f(bounds[t], bounds[t + 1]);
+            }, threads);
+        }
+
+        /* Fills dest in chunks of roughly chunkEdges edges. The transfer of
+         * each chunk to the device is started as soon as it is built, so it
+         * overlaps with building the next chunk. elems(begin, end) returns the
+         * range of elements in dest written for the vertices [begin, end).
+         */
+        template<typename T, typename SrcV, typename R, typename F>
         void
-        loadData(const Accessor<V>& raw_vertices, const Accessor<E>& raw_edges)
+        buildChunked(alloc_t<T>& dest, const SrcV *offsets, R elems, F f)
         {
-            std::get<n>(struct_edges) = p.template
-                allocConstant<struct edge<E>>(edge_count);
-            std::get<n>(vertices) = p.template
-                allocConstant<V>(vertex_count + 1);
-            std::get<n>(in_edges) = p.template allocConstant<E>(edge_count);
-            std::get<n>(out_edges) = p.template allocConstant<E>(edge_count);
-
-            for (E i = 0; i < vertex_count; i++) {
-                std::get<n>(vertices)[i] = raw_vertices[i];
-                for (size_t j = raw_vertices[i]; j < raw_vertices[i+1]; j++) {
-                    std::get<n>(struct_edges)[j].in = i;
-                    std::get<n>(in_edges)[j] = i;
-
-                    std::get<n>(struct_edges)[j].out = raw_edges[j];
-                    std::get<n>(out_edges)[j] = raw_edges[j];
+            size_t begin = 0;
+            while (begin < vertex_count) {
+                size_t limit = offsets[begin] + chunkEdges;
+                auto it = std::upper_bound(offsets + begin + 1,
+                                           offsets + vertex_count, limit);
+                size_t end = static_cast<size_t>(it - offsets);
+
+                parallelVertices(offsets, begin, end, f);
+
+                auto [firstElem, lastElem] = elems(begin, end);
+                if (firstElem < lastElem) {
+                    dest.copyHostToDevAsync(firstElem * sizeof(T),
+                                            (lastElem - firstElem) * sizeof(T));
                 }
+                begin = end;
             }
-            std::get<n>(vertices)[vertex_count] = raw_vertices[vertex_count];
+        }
+
+        std::pair<size_t,size_t>
+        vertexElems(size_t begin, size_t end) const
+        { return {begin, end == vertex_count ? end + 1 : end}; }
+
+        template<typename SrcV>
+        static auto
+        edgeElems(const SrcV *offsets)
+        {
+            return [offsets](size_t begin, size_t end) {
+                return std::pair<size_t,size_t>(offsets[begin], offsets[end]);
+            };
+        }
+
+        alloc_t<V>& getVertices(Dir dir)
+        {
+            dir = source(dir);
+            auto& dest = get(vertices, dir);
+            if (dest) return dest;
+
+            const auto& raw = rawVertices(dir);
+            mapOrAlloc(dest, raw, vertex_count + 1);
+            if (mappable(raw)) return dest;
+
+            V *result = dest.operator->();
+            raw.visit([&](auto src_vertices) {
+                result[vertex_count] =
+                    static_cast<V>(src_vertices[vertex_count]);
+
+                auto elems = [this](size_t begin, size_t end) {
+                    return vertexElems(begin, end);
+                };
+
+                buildChunked(dest, src_vertices, elems,
+                    [&](size_t begin, size_t end) {
+                        for (size_t i = begin; i < end; i++) {
+                            result[i] = static_cast<V>(src_vertices[i]);
+                        }
+                    });
+            });
+            return dest;
+        }
+
+        alloc_t<E>& getOutEdges(Dir dir)
+        {
+            dir = source(dir);
+            auto& dest = get(out_edges, dir);
+            if (dest) return dest;
+
+            const auto& raw = rawEdges(dir);
+            mapOrAlloc(dest, raw, edge_count);
+            if (mappable(raw)) return dest;
+
+            E *result = dest.operator->();
+            rawVertices(dir).visit([&](auto src_vertices) {
+                raw.visit([&](auto src_edges) {
+                    buildChunked(dest, src_vertices, edgeElems(src_vertices),
+                        [&](size_t begin, size_t end) {
+                            for (size_t j = src_vertices[begin];
+                                 j < src_vertices[end]; j++) {
+                                result[j] = static_cast<E>(src_edges[j]);
+                            }
+                        });
+                });
+            });
+            return dest;
+        }
+
+        alloc_t<E>& getInEdges(Dir dir)
+        {
+            dir = source(dir);
+            auto& dest = get(in_edges, dir);
+            if (dest) return dest;
+
+            dest = p.template allocConstant<E>(edge_count);
+            bytes += edge_count * sizeof(E);
+
+            E *result = dest.operator->();
+            rawVertices(dir).visit([&](auto src_vertices) {
+                buildChunked(dest, src_vertices, edgeElems(src_vertices),
+                    [&](size_t begin, size_t end) {
+                        for (size_t i = begin; i < end; i++) {
+                            for (size_t j = src_vertices[i];
+                                 j < src_vertices[i+1]; j++) {
+                                result[j] = static_cast<E>(i);
+                            }
+                        }
+                    });
+            });
+            return dest;
+        }
+
+        alloc_t<struct edge<E>>& getStructEdges(Dir dir)
+        {
+            dir = source(dir);
+            auto& dest = get(struct_edges, dir);
+            if (dest) return dest;
+
+            dest = p.template allocConstant<struct edge<E>>(edge_count);
+            bytes += edge_count * sizeof(struct edge<E>);
+
+            struct edge<E> *result = dest.operator->();
+            rawVertices(dir).visit([&](auto src_vertices) {
+                rawEdges(dir).visit([&](auto src_edges) {
+                    buildChunked(dest, src_vertices, edgeElems(src_vertices),
+                        [&](size_t begin, size_t end) {
+                            for (size_t i = begin; i < end; i++) {
+                                for (size_t j = src_vertices[i];
+                                     j < src_vertices[i+1]; j++) {
+                                    result[j].in = static_cast<E>(i);
+                                    result[j].out = static_cast<E>(src_edges[j]);
+                                }
+                            }
+                        });
+                });
+            });
+            return dest;
         }
 
       public:
         size_t vertex_count, edge_count;
+        size_t bytes;
+
+        RawData()
+         : p(Platform::get()), graph(nullptr)
+         , vertex_count(0), edge_count(0), bytes(0)
+        {}
 
-        RawData(const Graph<V,E>& graph) : p(Platform::get())
+        void bind(const Graph<V,E>& g)
         {
-            vertex_count = graph.vertex_count;
-            edge_count = graph.edge_count;
-            loadData<0>(graph.raw_vertices, graph.raw_edges);
-            loadData<1>(graph.raw_rev_vertices, graph.raw_rev_edges);
+            graph = &g;
+            vertex_count = g.vertex_count;
+            edge_count = g.edge_count;
+        }
+
+        void unbind()
+        { graph = nullptr; }
+
+        /* Frees the arrays not used by any of the representations in the
+         * loaded mask of repBit()s. Requires a bound graph.
+         */
+        void release(uint32_t loaded)
+        {
+            pair<bool> needVertices{false, false}, needStruct{false, false};
+            pair<bool> needIn{false, false}, needOut{false, false};
+
+            for (auto dir : { Dir::Forward, Dir::Reverse }) {
+                Dir src = source(dir);
+                auto uses = [&](Rep rep) { return loaded & repBit(rep, dir); };
+
+                if (uses(Rep::EdgeList) || uses(Rep::EdgeListCSR)) {
+                    get(needIn, src) = true;
+                    get(needOut, src) = true;
+                }
+                if (uses(Rep::StructEdgeList) || uses(Rep::StructEdgeListCSR)) {
+                    get(needStruct, src) = true;
+                }
+                if (uses(Rep::EdgeListCSR) || uses(Rep::StructEdgeListCSR)
+                    || uses(Rep::CSR)) {
+                    get(needVertices, src) = true;
+                }
+                if (uses(Rep::CSR)) get(needOut, src) = true;
+            }
+
+            for (auto dir : { Dir::Forward, Dir::Reverse }) {
+                if (!get(needVertices, dir)) {
+                    release(get(vertices, dir), vertex_count + 1,
+                            mappable(rawVertices(dir)));
+                }
+                if (!get(needOut, dir)) {
+                    release(get(out_edges, dir), edge_count,
+                            mappable(rawEdges(dir)));
+                }
+                if (!get(needIn, dir)) {
+                    release(get(in_edges, dir), edge_count, false);
+                }
+                if (!get(needStruct, dir)) {
+                    release(get(struct_edges, dir), edge_count, false);
+                }
+            }
         }
 
         void load(alloc_t<EdgeList<E>>& dest, Dir dir)
@@ -161,8 +445,8 @@ class GraphLoader
                 dest = p.template allocConstant<EdgeList<E>>();
                 dest->vertex_count = vertex_count;
                 dest->edge_count = edge_count;
-                dest.registerLocalAlloc(&dest->inEdges, get(in_edges, dir));
-                dest.registerLocalAlloc(&dest->outEdges, get(out_edges, dir));
+                dest.registerLocalAlloc(&dest->inEdges, getInEdges(dir));
+                dest.registerLocalAlloc(&dest->outEdges, getOutEdges(dir));
             }
         }
 
@@ -172,7 +456,7 @@ class GraphLoader
                 dest = p.template allocConstant<StructEdgeList<E>>();
                 dest->vertex_count = vertex_count;
                 dest->edge_count = edge_count;
-                dest.registerLocalAlloc(&dest->edges, get(struct_edges, dir));
+                dest.registerLocalAlloc(&dest->edges, getStructEdges(dir));
             }
         }
 
@@ -182,9 +466,9 @@ class GraphLoader
                 dest = p.template allocConstant<EdgeListCSR<V,E>>();
                 dest->vertex_count = vertex_count;
                 dest->edge_count = edge_count;
-                dest.registerLocalAlloc(&dest->vertices, get(vertices, dir));
-                dest.registerLocalAlloc(&dest->inEdges, get(in_edges, dir));
-                dest.registerLocalAlloc(&dest->outEdges, get(out_edges, dir));
+                dest.registerLocalAlloc(&dest->vertices, getVertices(dir));
+                dest.registerLocalAlloc(&dest->inEdges, getInEdges(dir));
+                dest.registerLocalAlloc(&dest->outEdges, getOutEdges(dir));
             }
         }
 
@@ -194,8 +478,8 @@ class GraphLoader
                 dest = p.template allocConstant<StructEdgeListCSR<V,E>>();
                 dest->vertex_count = vertex_count;
                 dest->edge_count = edge_count;
-                dest.registerLocalAlloc(&dest->vertices, get(vertices, dir));
-                dest.registerLocalAlloc(&dest->edges, get(struct_edges, dir));
+                dest.registerLocalAlloc(&dest->vertices, getVertices(dir));
+                dest.registerLocalAlloc(&dest->edges, getStructEdges(dir));
             }
         }
 
@@ -205,22 +489,46 @@ class GraphLoader
                 dest = p.template allocConstant<CSR<V,E>>();
                 dest->vertex_count = vertex_count;
                 dest->edge_count = edge_count;
-                dest.registerLocalAlloc(&dest->vertices, get(vertices, dir));
-                dest.registerLocalAlloc(&dest->edges, get(out_edges, dir));
+                dest.registerLocalAlloc(&dest->vertices, getVertices(dir));
+                dest.registerLocalAlloc(&dest->edges, getOutEdges(dir));
             }
         }
     };
 
+    /* Everything loaded for one graph, kept separate from the loader so it
+     * can outlive a job in the GraphCache.
+     */
+    struct Storage {
+        std::shared_ptr<Graph<V,E>> graph;
+        size_t graphBytes = 0;
+        std::optional<DegreeProperties> degrees;
+
+        RawData data;
+        uint32_t transferred = 0;
+
+        // Representations loaded on demand, least recently used first.
+        std::vector<GraphRep> recent;
+
+        pair<size_t> vertexCount;
+        pair<size_t> edgeCount;
+        pair<alloc_t<EdgeList<E>>> edgeList;
+        pair<alloc_t<StructEdgeList<E>>> structEdgeList;
+        pair<alloc_t<EdgeListCSR<V,E>>> edgeListCSR;
+        pair<alloc_t<StructEdgeListCSR<V,E>>> structEdgeListCSR;
+        pair<alloc_t<CSR<V,E>>> csr;
+    };
+
     template<Rep rep>
     struct LoadGraph
     {
         static void
-        call(Dir dir, GraphLoader& loader, RawData& data)
+        call(Dir dir, Storage& storage)
         {
             using GraphType = typename LoaderRep<rep>::GraphType;
 
             if constexpr (isDeviceAlloc<GraphType>()) {
-                data.load(get(loader.*LoaderRep<rep>::field, dir), dir);
+                auto& dest = get(storage.*LoaderRep<rep>::field, dir);
+                storage.data.load(dest, dir);
             }
         }
     };
@@ -229,12 +537,33 @@ class GraphLoader
     struct TransferGraph
     {
         static void
-        call(Dir dir, GraphLoader& loader)
+        call(Dir dir, Storage& storage)
+        {
+            using GraphType = typename LoaderRep<rep>::GraphType;
+
+            if constexpr (isDeviceAlloc<GraphType>()) {
+                uint32_t bit = repBit(rep, dir);
+
+                if (!(storage.transferred & bit)) {
+                    get(storage.*LoaderRep<rep>::field, dir).copyHostToDev();
+                    storage.transferred |= bit;
+                }
+            }
+        }
+    };
+
+    template<Rep rep>
+    struct EvictGraph
+    {
+        static void
+        call(Dir dir, Storage& storage)
         {
             using GraphType = typename LoaderRep<rep>::GraphType;
 
             if constexpr (isDeviceAlloc<GraphType>()) {
-                get(loader.*LoaderRep<rep>::field, dir).copyHostToDev();
+                using Alloc = typename std::remove_reference<GraphType>::type;
+                get(storage.*LoaderRep<rep>::field, dir) = Alloc();
+                storage.transferred &= ~repBit(rep, dir);
             }
         }
     };
@@ -244,12 +573,21 @@ class GraphLoader
     get(pair<T>& x, Dir dir)
     { return dir == Dir::Forward ? std::get<0>(x) : std::get<1>(x); }
 
-    template<typename T>
-    struct GraphType;
+    static bool isDevice(GraphRep rep)
+    {
+        return rep.representation != Rep::VertexCount
+            && rep.representation != Rep::EdgeCount;
+    }
 
-    template<typename T>
-    struct GraphType<T GraphLoader::*>
-    { typedef decltype(get(std::declval<T>(), Dir::Forward)) type; };
+    static bool
+    contains(const std::vector<GraphRep>& reps, GraphRep rep)
+    { return std::find(reps.begin(), reps.end(), rep) != reps.end(); }
+
+    std::shared_ptr<Storage> storage;
+    bool bound = false;
+
+    size_t cachedBytes() const
+    { return storage->data.bytes + storage->graphBytes; }
 
   public:
     GraphLoader() {}
@@ -257,107 +595,197 @@ class GraphLoader
     template<Rep rep, Dir dir>
     typename LoaderRep<rep>::GraphType&
     getGraph()
-    { return get(this->*LoaderRep<rep>::field, dir); }
+    { return get((*storage).*LoaderRep<rep>::field, dir); }
+
+    /* Opens the graph in fileName. A cached graph is reused together with
+     * its representations and degree properties, otherwise other entries
+     * are evicted to make room for its resident size before it is loaded.
+     */
+    std::shared_ptr<Graph<V,E>>
+    openGraph(const std::string& fileName)
+    {
+        auto& cache = GraphCache::get();
+
+        storage = cache.lookup<Storage>(fileName);
+        if (storage) return storage->graph;
+
+        size_t bytes = Graph<V,E>::residentSize(fileName);
+        cache.reserve<Storage>(fileName, bytes);
+
+        storage = std::make_shared<Storage>();
+        storage->graph = std::make_shared<Graph<V,E>>(fileName);
+        storage->graphBytes = bytes;
+        return storage->graph;
+    }
+
+    const DegreeProperties&
+    degreeProperties(const std::string& cacheDir)
+    {
+        if (!storage->degrees) {
+            storage->degrees = storage->graph->degreeProperties(cacheDir);
+        }
+        return *storage->degrees;
+    }
 
     std::pair<size_t,size_t>
-    loadGraph(const Graph<V,E>& graph, GraphRep rep)
-    { return loadGraph(graph, std::vector<GraphRep>{rep}); }
+    loadGraph(GraphRep rep)
+    { return loadGraph(std::vector<GraphRep>{rep}); }
 
+    /* Loads reps of the graph from the last openGraph(). */
     std::pair<size_t,size_t>
-    loadGraph(const Graph<V,E>& graph, const std::vector<GraphRep>& reps)
+    loadGraph(const std::vector<GraphRep>& reps)
     {
-        RawData data(graph);
+        RawData& data = storage->data;
+        data.bind(*storage->graph);
+
+        storage->vertexCount = {data.vertex_count, data.vertex_count};
+        storage->edgeCount = {data.edge_count, data.edge_count};
 
-        vertexCount = {data.vertex_count, data.vertex_count};
-        edgeCount = {data.edge_count, data.edge_count};
+        for (auto rep : reps) runWithGraphRep<LoadGraph>(rep, *storage);
 
-        for (auto rep : reps) runWithGraphRep<LoadGraph>(rep, *this, data);
+        data.unbind();
+        GraphCache::get().store(storage->graph->fileName, storage,
+                                cachedBytes());
 
         return {data.vertex_count, data.edge_count};
     }
 
     void transferGraph(GraphRep rep)
-    { runWithGraphRep<TransferGraph>(rep, *this); }
+    { runWithGraphRep<TransferGraph>(rep, *storage); }
 
-    void freeGraph()
+    /* Like loadGraph() without any representations, but keeps the graph
+     * bound until freeGraph(), so representations can be loaded when first
+     * needed by loadOnDemand().
+     */
+    std::pair<size_t,size_t>
+    bindGraph()
+    {
+        auto result = loadGraph(std::vector<GraphRep>());
+        bound = true;
+        storage->data.bind(*storage->graph);
+
+        // Representations a cached storage already has resident.
+        for (auto rep : { Rep::EdgeList, Rep::StructEdgeList, Rep::EdgeListCSR
+                        , Rep::StructEdgeListCSR, Rep::CSR }) {
+            for (auto dir : { Dir::Forward, Dir::Reverse }) {
+                GraphRep r{rep, dir};
+                if (storage->transferred & repBit(rep, dir)
+                    && !contains(storage->recent, r)) {
+                    storage->recent.push_back(r);
+                }
+            }
+        }
+        return result;
+    }
+
+    bool resident(const std::vector<GraphRep>& reps) const
     {
-        std::get<0>(edgeList).free();
-        std::get<1>(edgeList).free();
-        std::get<0>(structEdgeList).free();
-        std::get<1>(structEdgeList).free();
-        std::get<0>(edgeListCSR).free();
-        std::get<1>(edgeListCSR).free();
-        std::get<0>(structEdgeListCSR).free();
-        std::get<1>(structEdgeListCSR).free();
-        std::get<0>(csr).free();
-        std::get<1>(csr).free();
+        return std::all_of(reps.begin(), reps.end(), [this](GraphRep rep) {
+            return !isDevice(rep)
+                || storage->transferred & repBit(rep.representation,
+                                                 rep.direction);
+        });
     }
 
-  private:
-    pair<size_t> vertexCount;
-    pair<size_t> edgeCount;
-    pair<alloc_t<EdgeList<E>>> edgeList;
-    pair<alloc_t<StructEdgeList<E>>> structEdgeList;
-    pair<alloc_t<EdgeListCSR<V,E>>> edgeListCSR;
-    pair<alloc_t<StructEdgeListCSR<V,E>>> structEdgeListCSR;
-    pair<alloc_t<CSR<V,E>>> csr;
+    /* Loads and transfers those of reps that aren't resident, then evicts
+     * the least recently used other representations until the loaded data
+     * fits in budget bytes (0 is unlimited). Requires bindGraph().
+     */
+    void loadOnDemand(const std::vector<GraphRep>& reps, size_t budget)
+    {
+        auto& recent = storage->recent;
+        for (auto rep : reps) {
+            if (!isDevice(rep)) continue;
+
+            auto it = std::find(recent.begin(), recent.end(), rep);
+            if (it != recent.end()) recent.erase(it);
+            recent.push_back(rep);
+
+            runWithGraphRep<LoadGraph>(rep, *storage);
+            runWithGraphRep<TransferGraph>(rep, *storage);
+        }
+
+        RawData& data = storage->data;
+        for (auto it = recent.begin(); budget && data.bytes > budget
+                                       && it != recent.end();) {
+            if (contains(reps, *it)) {
+                ++it;
+                continue;
+            }
+
+            runWithGraphRep<EvictGraph>(*it, *storage);
+            it = recent.erase(it);
+            data.release(storage->transferred);
+        }
+    }
+
+    void freeGraph()
+    {
+        if (bound) {
+            storage->data.unbind();
+            GraphCache::get().store(storage->graph->fileName, storage,
+                                    cachedBytes());
+            bound = false;
+        }
+        storage.reset();
+    }
 };
 
 template<typename Platform, typename V, typename E>
 struct LoaderRep<Rep::VertexCount, Platform, V, E>
 {
-    using Loader = GraphLoader<Platform,V,E>;
-    static constexpr auto Loader::* field = &Loader::vertexCount;
-    using FieldType = decltype(std::get<0>(std::declval<Loader>().*field));
+    using Storage = typename GraphLoader<Platform,V,E>::Storage;
+    static constexpr auto Storage::* field = &Storage::vertexCount;
+    using FieldType = decltype(std::get<0>(std::declval<Storage>().*field));
     typedef typename std::remove_reference<FieldType>::type GraphType;
 };
 
 template<typename Platform, typename V, typename E>
 struct LoaderRep<Rep::EdgeCount, Platform, V, E>
 {
-    using Loader = GraphLoader<Platform,V,E>;
-    static constexpr auto Loader::* field = &Loader::edgeCount;
-    using FieldType = decltype(std::get<0>(std::declval<Loader>().*field));
+    using Storage = typename GraphLoader<Platform,V,E>::Storage;
+    static constexpr auto Storage::* field = &Storage::edgeCount;
+    using FieldType = decltype(std::get<0>(std::declval<Storage>().*field));
     typedef typename std::remove_reference<FieldType>::type GraphType;
 };
 
 template<typename Platform, typename V, typename E>
 struct LoaderRep<Rep::EdgeList, Platform, V, E>
 {
-    using Loader = GraphLoader<Platform,V,E>;
-    static constexpr auto Loader::* field = &Loader::edgeList;
-    typedef decltype(std::get<0>(std::declval<Loader>().*field)) GraphType;
+    using Storage = typename GraphLoader<Platform,V,E>::Storage;
+    static constexpr auto Storage::* field = &Storage::edgeList;
+    typedef decltype(std::get<0>(std::declval<Storage>().*field)) GraphType;
 };
 
 template<typename Platform, typename V, typename E>
 struct LoaderRep<Rep::StructEdgeList, Platform, V, E>
 {
-    using Loader = GraphLoader<Platform,V,E>;
-    static constexpr auto Loader::* field = &Loader::structEdgeList;
-    typedef decltype(std::get<0>(std::declval<Loader>().*field)) GraphType;
+    using Storage = typename GraphLoader<Platform,V,E>::Storage;
+    static constexpr auto Storage::* field = &Storage::structEdgeList;
+    typedef decltype(std::get<0>(std::declval<Storage>().*field)) GraphType;
 };
 
 template<typename Platform, typename V, typename E>
 struct LoaderRep<Rep::EdgeListCSR, Platform, V, E>
 {
-    using Loader = GraphLoader<Platform,V,E>;
-    static constexpr auto Loader::* field = &Loader::edgeListCSR;
-    typedef decltype(std::get<0>(std::declval<Loader>().*field)) GraphType;
+    using Storage = typename GraphLoader<Platform,V,E>::Storage;
+    static constexpr auto Storage::* field = &Storage::edgeListCSR;
+    typedef decltype(std::get<0>(std::declval<Storage>().*field)) GraphType;
 };
 
 template<typename Platform, typename V, typename E>
 struct LoaderRep<Rep::StructEdgeListCSR, Platform, V, E>
 {
-    using Loader = GraphLoader<Platform,V,E>;
-    static constexpr auto Loader::* field = &Loader::structEdgeListCSR;
-    typedef decltype(std::get<0>(std::declval<Loader>().*field)) GraphType;
+    using Storage = typename GraphLoader<Platform,V,E>::Storage;
+    static constexpr auto Storage::* field = &Storage::structEdgeListCSR;
+    typedef decltype(std::get<0>(std::declval<Storage>().*field)) GraphType;
 };
 
 template<typename Platform, typename V, typename E>
 struct LoaderRep<Rep::CSR, Platform, V, E>
 {
-    using Loader = GraphLoader<Platform,V,E>;
-    static constexpr auto Loader::* field = &Loader::csr;
-    typedef decltype(std::get<0>(std::declval<Loader>().*field)) GraphType;
+    using Storage = typename GraphLoader<Platform,V,E>::Storage;
+    static constexpr auto Storage::* field = &Storage::csr;
+    typedef decltype(std::get<0>(std::declval<Storage>().*field)) GraphType;
 };
 #endif
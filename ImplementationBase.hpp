@@ -6,13 +6,18 @@
 struct ImplementationBase {
   private:
     bool validate_;
+    bool binaryOutput_;
   protected:
-    ImplementationBase() : validate_(false), run_count(1), validate(validate_)
+    ImplementationBase()
+      : validate_(false), binaryOutput_(false), run_count(1)
+      , validate(validate_), binaryOutput(binaryOutput_)
     {
         options.add('n', "count", "NUM", run_count,
                     "Number of times to run algorithm.");
         options.add("validate", validate_, true,
                     "Output validation results.");
+        options.add('B', "binary-output", binaryOutput_, true,
+                    "Write results in the binary result format.");
     }
 
     ImplementationBase(const ImplementationBase&) = delete;
@@ -29,6 +34,7 @@ struct ImplementationBase {
 
   public:
     const bool& validate;
+    const bool& binaryOutput;
     void operator()(const std::string& graphFile, std::ofstream&& output);
     void operator()(const std::string& graphFile, const std::string& output);
     void help(std::ostream& out, std::string prefix);
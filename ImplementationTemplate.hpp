@@ -2,9 +2,13 @@
 #define IMPLEMENTATIONTEMPLATE_HPP
 
 #include <fstream>
+#include <functional>
+#include <limits>
 
+#include "DecisionTree.hpp"
 #include "ImplementationBase.hpp"
 #include "GraphLoader.hpp"
+#include "PropertyLog.hpp"
 #include "Timer.hpp"
 
 #define tag_t(v) (tag_t<decltype(v), v>{})
@@ -321,13 +325,26 @@ template<>
 struct ImplementationTemplateBase<true> : public ImplementationBase
 {
     static constexpr bool isSwitching = true;
+    // Algorithms that call oracleStep() set this to accept -x/--oracle.
+    static constexpr bool usesOracle = false;
     virtual ~ImplementationTemplateBase();
     virtual void predictInitial() = 0;
     virtual bool predict() = 0;
 
-    refmap<std::string,prop_ref> graphProperties;
-    refmap<std::string,prop_ref> algorithmProperties;
+    // Runs step() once with every implementation, starting each from the
+    // state captured by save(0). The state after the fastest run is kept
+    // (using save(1)/restore(1) if a slower one ran after it) and the fastest
+    // implementation is selected for the following steps. Returns the
+    // fastest run's time in clock ticks.
+    virtual uint64_t oracleStep
+        ( const std::function<void(size_t)>& save
+        , const std::function<void(size_t)>& restore
+        , const std::function<void()>& step
+        ) = 0;
 
+    PropertyRegistry properties;
+
+    bool oracle = false;
 };
 
 template<typename Platform, typename V, typename E, bool switching>
@@ -370,19 +387,24 @@ struct ImplementationTemplate : public ImplementationTemplateBase<switching>
         backend.setWorkSizes(1, {div.first}, {div.second}, sharedMem);
     }
 
-    virtual void loadGraph(const Graph<V,E>&) = 0;
+    virtual void loadGraph(const std::shared_ptr<Graph<V,E>>&) = 0;
 
     virtual void transferGraph() = 0;
 
     void loadGraph(const std::string filename) override final
     {
+        Timer graphLoad("graphLoad", run_count);
         Timer graphTransfer("graphTransfer", run_count);
-        Graph<V,E>& graph(filename);
+        auto graph = loader.openGraph(filename);
 
+        // Building the representations already starts most of the transfer,
+        // so graphTransfer only covers what is left.
+        graphLoad.start();
         loadGraph(graph);
+        graphLoad.stop();
 
-        vertex_count = graph.vertex_count;
-        edge_count = graph.edge_count;
+        vertex_count = graph->vertex_count;
+        edge_count = graph->edge_count;
         vertexDivision = backend.computeDivision(vertex_count);
         edgeDivision = backend.computeDivision(edge_count);
 
@@ -437,7 +459,8 @@ struct SimpleImplementation : public AlgorithmBase
     }
 
   protected:
-    virtual void loadGraph(const Graph<Vertex,Edge>& graph) override final
+    virtual void
+    loadGraph(const std::shared_ptr<Graph<Vertex,Edge>>&) override final
     {
         std::vector<GraphRep> reps;
         auto load = [&reps](auto&& k) {
@@ -446,7 +469,7 @@ struct SimpleImplementation : public AlgorithmBase
 
         mapKernels(load);
 
-        loader.loadGraph(graph, reps);
+        loader.loadGraph(reps);
     }
 
     virtual void transferGraph() override final
@@ -507,16 +530,19 @@ make_implementation
     return std::make_unique<SimpleImpl>(kernels);
 }
 
-class prop_ref : public std::reference_wrapper<double>
+class prop_ref
 {
     static double dummyProp;
 
+    std::vector<double> *values;
+    size_t id;
+
   public:
     prop_ref(prop_ref&&) = delete;
     prop_ref(const prop_ref&) = delete;
 
     prop_ref(const std::string&, ImplementationTemplateBase<false>&)
-     : std::reference_wrapper<double>(dummyProp)
+     : values(nullptr), id(0)
     {}
 
     prop_ref
@@ -524,20 +550,18 @@ class prop_ref : public std::reference_wrapper<double>
         , ImplementationTemplateBase<true>& cfg
         , bool graphProp = false
         )
-        : std::reference_wrapper<double>(dummyProp)
-    {
-        if (graphProp) cfg.graphProperties.emplace(name, std::ref(*this));
-        else cfg.algorithmProperties.emplace(name, std::ref(*this));
-    }
+        : values(&cfg.properties.values)
+        , id(cfg.properties.add(name, graphProp))
+    {}
 
-    prop_ref& operator=(const std::reference_wrapper<double>& val)
-    { std::reference_wrapper<double>::operator=(val); return *this; }
+    double& get() const
+    { return values ? (*values)[id] : dummyProp; }
 
-    double& operator=(const double& val)
-    { return this->get() = val; }
+    operator double&() const
+    { return get(); }
 
-    void reset()
-    { operator=(std::ref(dummyProp)); }
+    double& operator=(const double& val)
+    { return get() = val; }
 };
 
 double prop_ref::dummyProp = 0;
@@ -547,13 +571,11 @@ struct SwitchImplementation : public AlgorithmBase
 {
     using typename AlgorithmBase::Vertex;
     using typename AlgorithmBase::Edge;
-    using AlgorithmBase::algorithmProperties;
-    using AlgorithmBase::graphProperties;
+    using AlgorithmBase::properties;
     using AlgorithmBase::loader;
     using AlgorithmBase::options;
     using AlgorithmBase::setKernelConfig;
 
-    using prop_set =  std::set<std::string>;
     using KernelMap = KernelMap<std::string,std::tuple<Kernels...>>;
 
     std::tuple<Kernels...> kernels;
@@ -615,17 +637,36 @@ struct SwitchImplementation : public AlgorithmBase
       , max("max ", " degree", *this)
       , stdDev("stddev ", " degree", *this)
     {
-        options.add('m', "model", "FILE", model, "Prediction model to use.");
+        options.add('m', "model", "FILE", model,
+                    "Prediction model to use, a shared library or tree file.");
         options.add('l', "log", "FILE", logFile, "Where to log properties.");
+        options.add('P', "binary-log", binaryLog, true,
+                    "Write the property log in binary, see "
+                    "convert-property-log.");
+        if constexpr (AlgorithmBase::usesOracle) {
+            options.add('x', "oracle", this->oracle, true,
+                        "Time every implementation at each step and continue "
+                        "with the fastest.");
+        }
+        options.add('z', "lazy-load", lazyLoad, true,
+                    "Load an implementation's graph representations when it "
+                    "is first selected.");
+        options.add('M', "rep-budget", "MB", repBudget,
+                    "Memory budget for lazily loaded representations, least "
+                    "recently used ones are evicted (0 is unlimited).");
+        options.add('G', "degree-cache", "DIR", degreeCache,
+                    "Directory for caching the graph's degree distributions.");
     }
 
-    virtual void loadGraph(const Graph<Vertex,Edge>& graph) override final
+    virtual void
+    loadGraph(const std::shared_ptr<Graph<Vertex,Edge>>& graph) override final
     {
-        vertices = graph.vertex_count;
-        edges = graph.edge_count;
+        vertices = graph->vertex_count;
+        edges = graph->edge_count;
 
+        auto& props = loader.degreeProperties(degreeCache);
         for (const auto& type : { Degrees::abs, Degrees::in, Degrees::out }) {
-            auto summary = graph.degreeStatistics(type);
+            auto summary = props.summary(type);
 
             min[type] = summary.min;
             lowerQuantile[type] = summary.lowerQuantile;
@@ -641,15 +682,22 @@ struct SwitchImplementation : public AlgorithmBase
             reps.push_back(k->representation);
         };
 
+        if (lazyLoad) {
+            loader.bindGraph();
+            return;
+        }
+
         for (auto& impl : implementations) {
             mapKernels(load, impl);
         }
 
-        loader.loadGraph(graph, reps);
+        loader.loadGraph(reps);
     }
 
     virtual void transferGraph() override final
     {
+        if (lazyLoad) return;
+
         auto transfer = [this](auto&& k) {
             loader.transferGraph(k->representation);
         };
@@ -663,24 +711,28 @@ struct SwitchImplementation : public AlgorithmBase
     virtual void predictInitial() override final
     {
         stepNum = 0;
-        logGraphProps();
-        logAlgorithmProps();
+        if (propLog) {
+            propLog.logGraph(properties);
+            propLog.logStep(stepNum, properties);
+        }
 
         lastKernel = lookup();
         if (lastKernel == -1) lastKernel = defaultKernel;
 
         kernels = implementations[static_cast<size_t>(lastKernel)];
+        loadRepresentations();
     }
 
     virtual bool predict() override final
     {
         ++stepNum;
-        logAlgorithmProps();
+        if (propLog) propLog.logStep(stepNum, properties);
 
         int32_t result = lookup();
         if (result != -1 && result != lastKernel) {
             kernels = implementations[static_cast<size_t>(result)];
             lastKernel = result;
+            loadRepresentations();
 
             return true;
         }
@@ -688,24 +740,48 @@ struct SwitchImplementation : public AlgorithmBase
         return false;
     }
 
-    virtual void prepareRun() override final
+    virtual uint64_t
+    oracleStep
+    ( const std::function<void(size_t)>& save
+    , const std::function<void(size_t)>& restore
+    , const std::function<void()>& step
+    ) override final
     {
-        prop_set missingGraphProps;
-        prop_set missingAlgoProps;
-
-        for (auto& pair : graphProperties) {
-            auto& [name, val] = pair;
-            missingGraphProps.insert(name);
+        save(0);
+
+        size_t best = 0;
+        uint64_t bestTime = std::numeric_limits<uint64_t>::max();
+        for (size_t i = 0; i < implementations.size(); i++) {
+            if (i) restore(0);
+            kernels = implementations[i];
+            loadRepresentations();
+
+            auto name = std::to_string(stepNum) + ":oracle-" + implIds[i].name;
+            auto& timer = oracleTimers.try_emplace({stepNum, i}, name, this->run_count)
+                                      .first->second;
+            timer.start();
+            step();
+            uint64_t time = timer.stop();
+
+            if (time < bestTime) {
+                bestTime = time;
+                best = i;
+                if (i + 1 < implementations.size()) save(1);
+            }
         }
 
-        for (auto& pair : algorithmProperties) {
-            auto& [name, val] = pair;
-            missingAlgoProps.insert(name);
-        }
+        if (best + 1 < implementations.size()) restore(1);
+        kernels = implementations[best];
+        lastKernel = static_cast<int32_t>(best);
+        loadRepresentations();
+        return bestTime;
+    }
 
+    virtual void prepareRun() override final
+    {
         lastKernel = -1;
         if (!model.empty()) {
-            setupPredictor(model.c_str(), missingGraphProps, missingAlgoProps);
+            setupPredictor(model.c_str());
         } else {
             lookup = []() { return -1; };
 
@@ -717,15 +793,18 @@ struct SwitchImplementation : public AlgorithmBase
             defaultKernel = 0;
             implIds.emplace_back(-1, "edge-list");
             implementations.emplace_back(kernels);
-        }
 
-        if (!logFile.empty()) {
-            setupLogging(missingGraphProps, missingAlgoProps);
-        } else {
-            logGraphProps = [](){};
-            logAlgorithmProps = [](){};
+            if (this->oracle) {
+                for (auto& [name, ks] : kernelMap) {
+                    if (name == "edge-list") continue;
+                    implIds.emplace_back(-1, name);
+                    implementations.emplace_back(ks);
+                }
+            }
         }
 
+        if (!logFile.empty()) setupLogging();
+
         bool anyUninitialised = false;
         auto checkInitialised = [&anyUninitialised](auto&& k) {
             if (k == nullptr) anyUninitialised = true;
@@ -743,6 +822,8 @@ struct SwitchImplementation : public AlgorithmBase
         lastKernel = -1;
         implIds.clear();
         implementations.clear();
+        oracleTimers.clear();
+        loadTimers.clear();
 
         if (modelHandle) {
             int result = dlclose(modelHandle);
@@ -750,28 +831,62 @@ struct SwitchImplementation : public AlgorithmBase
             modelHandle = nullptr;
         }
 
-        if (!logFile.empty()) propLog = std::ofstream();
+        tree = DecisionTree();
+        modelInputs.clear();
+        propLog.close();
+        properties.reset();
+    }
 
-        for (auto& pair : graphProperties) {
-            auto& [name, prop] = pair;
-            prop.get().reset();
-        }
+  private:
+    // In lazy mode, loads the representations of the selected kernels that
+    // aren't resident yet, timed as part of the current step.
+    void loadRepresentations()
+    {
+        if (!lazyLoad) return;
 
-        for (auto& pair : algorithmProperties) {
-            auto& [name, prop] = pair;
-            prop.get().reset();
+        std::vector<GraphRep> reps;
+        mapKernels([&reps](auto&& k) { reps.push_back(k->representation); },
+                   kernels);
+
+        Timer *timer = nullptr;
+        if (!loader.resident(reps)) {
+            auto name = std::to_string(stepNum) + ":representationLoad";
+            timer = &loadTimers.try_emplace(stepNum, name, this->run_count)
+                               .first->second;
+            timer->start();
         }
+
+        loader.loadOnDemand(reps, repBudget * 1024 * 1024);
+        if (timer) timer->stop();
     }
 
-  private:
     void
-    setupPredictor
-    (const char * const lib, prop_set& graphProps, prop_set& algoProps)
+    setupPredictor(const char * const lib)
     {
         typedef std::tuple<std::string,int64_t,size_t,size_t,size_t> impl_tuple;
         typedef std::reference_wrapper<double> double_ref;
         typedef const std::vector<impl_tuple> implementations_t;
-        typedef const std::map<std::string,double_ref> properties;
+        typedef const std::map<std::string,double_ref> properties_t;
+
+        if (DecisionTree::isTreeFile(lib)) {
+            tree.load(lib);
+            lookup = [this]() { return tree.lookup(); };
+            defaultKernel = tree.defaultImpl;
+
+            std::vector<std::pair<std::string,double_ref>> params;
+            for (auto& [name, idx] : tree.propertyNames) {
+                params.emplace_back(name, std::ref(tree.properties[idx]));
+            }
+
+            std::vector<impl_tuple> impls;
+            for (auto& impl : tree.implementations) {
+                impls.emplace_back(impl.name, impl.id, impl.idx, impl.warp,
+                                   impl.chunk);
+            }
+
+            bindPredictor(params, impls);
+            return;
+        }
 
         modelHandle = dlopen(lib, RTLD_NOW);
         if (!modelHandle) {
@@ -780,26 +895,38 @@ struct SwitchImplementation : public AlgorithmBase
 
         lookup = safe_dlsym<int32_t()>(modelHandle, "lookup");
         const auto& impls = *safe_dlsym<implementations_t>(modelHandle, "implNames");
-        const auto& params = *safe_dlsym<properties>(modelHandle, "propNames");
+        const auto& params = *safe_dlsym<properties_t>(modelHandle, "propNames");
         defaultKernel = *safe_dlsym<int32_t>(modelHandle, "default_impl");
 
+        bindPredictor(params, impls);
+    }
+
+    template<typename Properties, typename Implementations>
+    void
+    bindPredictor
+    (const Properties& params, const Implementations& impls)
+    {
         bool missing = false;
         for (auto& pair : params) {
             auto& [name, prop] = pair;
-            try {
-                graphProperties[name] = prop;
-                graphProps.erase(name);
-            } catch (const std::out_of_range&) {
-                try {
-                    algorithmProperties[name] = prop;
-                    algoProps.erase(name);
-                } catch (const std::out_of_range&) {
-                    std::cerr << "Missing property: " << name << std::endl;
-                    missing = true;
-                }
+            size_t id;
+            if (properties.find(name, id)) {
+                modelInputs.emplace_back(id, &prop.get());
+            } else {
+                std::cerr << "Missing property: " << name << std::endl;
+                missing = true;
             }
         }
 
+        // Models read their inputs from their own storage, so copy the
+        // properties they use before every prediction.
+        lookup = [this,predictor{lookup}]() {
+            for (auto& [id, input] : modelInputs) {
+                *input = properties.values[id];
+            }
+            return predictor();
+        };
+
         implIds.resize(impls.size());
         implementations.resize(impls.size());
         for (auto& data : impls) {
@@ -826,10 +953,9 @@ struct SwitchImplementation : public AlgorithmBase
         if (missing) reportError("Missing properties/implementations!");
     }
 
-    void setupLogging(prop_set& missingGraphProps, prop_set& missingAlgoProps)
+    void setupLogging()
     {
-        propLog = std::ofstream(logFile);
-        propLog.imbue(std::locale("C"));
+        propLog.open(logFile, binaryLog, properties);
         lookup = [this,oldPredictor{lookup}]() {
             int32_t result = oldPredictor();
             if (result == -1) {
@@ -837,42 +963,10 @@ struct SwitchImplementation : public AlgorithmBase
                 else result = lastKernel;
             }
 
-            propLog << "prediction:" << stepNum << ":"
-                    << implIds[static_cast<size_t>(result)].id << std::endl;
+            propLog.logPrediction(stepNum,
+                                  implIds[static_cast<size_t>(result)].id);
             return result;
         };
-
-        std::vector<std::pair<std::string,double>> graphProps;
-        graphProps.reserve(missingGraphProps.size());
-
-        for (auto& name : missingGraphProps) {
-            graphProps.emplace_back(name, 0);
-            graphProperties[name] = std::ref(graphProps.back().second);
-        }
-
-        logGraphProps = [this,props{std::move(graphProps)}]() {
-            for (auto& pair : graphProperties) {
-                auto& [name, ref] = pair;
-                propLog << "graph:" << name << ":" << ref.get()
-                        << std::endl;
-            }
-        };
-
-        std::vector<std::pair<std::string,double>> algoProps;
-        algoProps.reserve(missingAlgoProps.size());
-
-        for (auto& name : missingAlgoProps) {
-            algoProps.emplace_back(name, 0);
-            algorithmProperties[name] = std::ref(algoProps.back().second);
-        }
-
-        logAlgorithmProps = [this,props{std::move(algoProps)}]() {
-            for (auto& pair : algorithmProperties) {
-                auto& [name, ref] = pair;
-                propLog << "step:" << stepNum << ":" << name << ":"
-                        << ref.get() << std::endl;
-            }
-        };
     }
 
     template<typename Fun>
@@ -886,14 +980,18 @@ struct SwitchImplementation : public AlgorithmBase
     { (f(std::get<I>(ks)), ...); }
 
     std::string logFile;
+    bool binaryLog = false;
     std::string model;
+    bool lazyLoad = false;
+    size_t repBudget = 0;
+    std::string degreeCache;
 
     void *modelHandle;
+    DecisionTree tree;
     std::function<int32_t()> lookup;
 
-    std::ofstream propLog;
-    std::function<void()> logGraphProps;
-    std::function<void()> logAlgorithmProps;
+    std::vector<std::pair<size_t,double*>> modelInputs;
+    PropertyLog propLog;
 
     int32_t lastKernel;
     int32_t defaultKernel;
@@ -901,6 +999,8 @@ struct SwitchImplementation : public AlgorithmBase
     std::vector<struct impl_id> implIds;
     std::vector<std::tuple<Kernels...>> implementations;
     std::map<std::string,std::tuple<Kernels...>> kernelMap;
+    std::map<std::pair<size_t,size_t>,Timer> oracleTimers;
+    std::map<size_t,Timer> loadTimers;
 
     prop_ref vertices, edges;
     graph_prop min, lowerQuantile, mean, median, upperQuantile, max, stdDev;
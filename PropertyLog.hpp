@@ -0,0 +1,289 @@
+#ifndef PROPERTYLOG_HPP
+#define PROPERTYLOG_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ResultWriter.hpp"
+#include "utils/Util.hpp"
+
+// Properties of a switching implementation. Every property is assigned a
+// dense id when it is declared and its value is stored contiguously, so
+// updating, logging, and feeding them to a model doesn't involve any string
+// lookups. The graph and algorithm property ids are kept sorted by name.
+class PropertyRegistry {
+    std::map<std::string,size_t> ids;
+
+  public:
+    std::vector<std::string> names;
+    std::vector<double> values;
+    std::vector<size_t> graphProps, algorithmProps;
+
+    size_t add(const std::string& name, bool graphProp)
+    {
+        auto [it, inserted] = ids.emplace(name, names.size());
+        if (!inserted) return it->second;
+
+        names.push_back(name);
+        values.push_back(0);
+
+        auto& props = graphProp ? graphProps : algorithmProps;
+        auto pos = std::lower_bound(props.begin(), props.end(), name,
+            [this](size_t id, const std::string& n) { return names[id] < n; });
+        props.insert(pos, it->second);
+        return it->second;
+    }
+
+    bool find(const std::string& name, size_t& id) const
+    {
+        auto it = ids.find(name);
+        if (it == ids.end()) return false;
+        id = it->second;
+        return true;
+    }
+
+    void reset()
+    { std::fill(values.begin(), values.end(), 0.0); }
+};
+
+// Buffered writer for the property log of a switching implementation. The
+// text format is the one parsed by benchmark-analysis' ingest
+// ("graph:<name>:<value>", "step:<n>:<name>:<value>", and
+// "prediction:<n>:<id>" lines). The binary format starts with magic
+// "BLWPROPS", a uint32 version, and the uint32 counts of graph and algorithm
+// properties, followed by their names as uint32 length and bytes. Then
+// follow records of a tag byte and, for graph records, the doubles of the
+// graph properties, for step records the uint64 step and the doubles of the
+// algorithm properties, and for prediction records the uint64 step and the
+// int64 implementation id. All values are little-endian.
+class PropertyLog {
+    static constexpr size_t flushSize = 1 << 16;
+    static constexpr const char *magic = "BLWPROPS";
+
+    enum : char { graphRecord, stepRecord, predictionRecord };
+
+    std::ofstream out;
+    bool binary;
+    std::vector<std::string> graphNames, stepNames;
+    LineBuffer buffer;
+
+    void putLE(uint64_t value, size_t bytes)
+    {
+        for (size_t i = 0; i < bytes; i++) {
+            buffer.put(static_cast<char>((value >> (8 * i)) & 0xff));
+        }
+    }
+
+    void putDouble(double value)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof value);
+        putLE(bits, sizeof bits);
+    }
+
+    static uint64_t getLE(std::istream& in, size_t bytes)
+    {
+        unsigned char data[8];
+        if (!in.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(bytes))) {
+            reportError("Truncated property log!");
+        }
+
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; i++) value |= uint64_t(data[i]) << (8 * i);
+        return value;
+    }
+
+    static double getDouble(std::istream& in)
+    {
+        uint64_t bits = getLE(in, 8);
+        double value;
+        std::memcpy(&value, &bits, sizeof value);
+        return value;
+    }
+
+    static std::vector<std::string> getNames(std::istream& in, size_t count)
+    {
+        std::vector<std::string> result;
+        for (size_t i = 0; i < count; i++) {
+            std::string name(getLE(in, 4), '\0');
+            if (!in.read(&name[0], static_cast<std::streamsize>(name.size()))) {
+                reportError("Truncated property log!");
+            }
+            result.push_back(std::move(name));
+        }
+        return result;
+    }
+
+    void open
+    ( const std::string& fileName
+    , bool binaryLog
+    , std::vector<std::string> graph
+    , std::vector<std::string> step
+    )
+    {
+        out = std::ofstream(fileName, std::ios::binary);
+        if (!out) reportError("Failed to open property log: ", fileName);
+
+        binary = binaryLog;
+        graphNames = std::move(graph);
+        stepNames = std::move(step);
+        buffer.clear();
+
+        if (!binary) return;
+
+        buffer.put(magic);
+        putLE(1, 4);
+        putLE(graphNames.size(), 4);
+        putLE(stepNames.size(), 4);
+        for (auto& names : { &graphNames, &stepNames }) {
+            for (auto& name : *names) {
+                putLE(name.size(), 4);
+                buffer.put(name);
+            }
+        }
+    }
+
+    template<typename F>
+    void writeGraph(F&& value)
+    {
+        if (binary) {
+            buffer.put(static_cast<char>(graphRecord));
+            for (size_t i = 0; i < graphNames.size(); i++) putDouble(value(i));
+        } else {
+            for (size_t i = 0; i < graphNames.size(); i++) {
+                buffer.put("graph:").put(graphNames[i]).put(':')
+                      .put(value(i), 6).put('\n');
+            }
+        }
+        if (buffer.str().size() >= flushSize) flush();
+    }
+
+    template<typename F>
+    void writeStep(uint64_t step, F&& value)
+    {
+        if (binary) {
+            buffer.put(static_cast<char>(stepRecord));
+            putLE(step, 8);
+            for (size_t i = 0; i < stepNames.size(); i++) putDouble(value(i));
+        } else {
+            for (size_t i = 0; i < stepNames.size(); i++) {
+                buffer.put("step:").put(step).put(':').put(stepNames[i])
+                      .put(':').put(value(i), 6).put('\n');
+            }
+        }
+        if (buffer.str().size() >= flushSize) flush();
+    }
+
+    void flush()
+    {
+        auto& str = buffer.str();
+        out.write(str.data(), static_cast<std::streamsize>(str.size()));
+        buffer.clear();
+    }
+
+  public:
+    PropertyLog() : binary(false)
+    {}
+
+    explicit operator bool() const
+    { return out.is_open(); }
+
+    void open
+    (const std::string& fileName, bool binaryLog, const PropertyRegistry& props)
+    {
+        std::vector<std::string> graph, step;
+        for (auto id : props.graphProps) graph.push_back(props.names[id]);
+        for (auto id : props.algorithmProps) step.push_back(props.names[id]);
+        open(fileName, binaryLog, std::move(graph), std::move(step));
+    }
+
+    void logGraph(const PropertyRegistry& props)
+    {
+        writeGraph([&](size_t i) { return props.values[props.graphProps[i]]; });
+    }
+
+    void logStep(uint64_t step, const PropertyRegistry& props)
+    {
+        writeStep(step, [&](size_t i) {
+            return props.values[props.algorithmProps[i]];
+        });
+    }
+
+    void logPrediction(uint64_t step, int64_t id)
+    {
+        if (binary) {
+            buffer.put(static_cast<char>(predictionRecord));
+            putLE(step, 8);
+            putLE(static_cast<uint64_t>(id), 8);
+        } else {
+            buffer.put("prediction:").put(step).put(':').put(id).put('\n');
+        }
+        if (buffer.str().size() >= flushSize) flush();
+    }
+
+    void close()
+    {
+        if (!out.is_open()) return;
+        flush();
+        out.close();
+    }
+
+    ~PropertyLog()
+    { close(); }
+
+    // Rewrites a binary property log as the equivalent text log.
+    static void toText(const std::string& input, const std::string& output)
+    {
+        std::ifstream in(input, std::ios::binary);
+        if (!in) reportError("Failed to open property log: ", input);
+
+        char header[8];
+        if (!in.read(header, sizeof header)
+            || std::memcmp(header, magic, sizeof header)) {
+            reportError("Not a binary property log: ", input);
+        }
+        if (getLE(in, 4) != 1) {
+            reportError("Unsupported property log version: ", input);
+        }
+
+        size_t graphCount = getLE(in, 4);
+        size_t stepCount = getLE(in, 4);
+        auto graph = getNames(in, graphCount);
+        auto step = getNames(in, stepCount);
+
+        PropertyLog log;
+        log.open(output, false, std::move(graph), std::move(step));
+
+        std::vector<double> values;
+        auto value = [&values](size_t i) { return values[i]; };
+        for (int tag; (tag = in.get()) != std::char_traits<char>::eof();) {
+            switch (tag) {
+              case graphRecord:
+                values.resize(graphCount);
+                for (auto& v : values) v = getDouble(in);
+                log.writeGraph(value);
+                break;
+              case stepRecord: {
+                uint64_t stepNum = getLE(in, 8);
+                values.resize(stepCount);
+                for (auto& v : values) v = getDouble(in);
+                log.writeStep(stepNum, value);
+                break;
+              }
+              case predictionRecord: {
+                uint64_t stepNum = getLE(in, 8);
+                log.logPrediction(stepNum, static_cast<int64_t>(getLE(in, 8)));
+                break;
+              }
+              default:
+                reportError("Invalid record in property log: ", input);
+            }
+        }
+    }
+};
+#endif
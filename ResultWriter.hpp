@@ -0,0 +1,181 @@
+#ifndef RESULTWRITER_HPP
+#define RESULTWRITER_HPP
+
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "utils/Graph.hpp"
+
+// Output buffer for a chunk of result lines, formatting independent of the
+// stream's locale.
+class LineBuffer {
+    std::string buffer;
+
+  public:
+    void clear()
+    { buffer.clear(); }
+
+    const std::string& str() const
+    { return buffer; }
+
+    LineBuffer& put(char c)
+    {
+        buffer.push_back(c);
+        return *this;
+    }
+
+    LineBuffer& put(std::string_view str)
+    {
+        buffer.append(str);
+        return *this;
+    }
+
+    template<typename T>
+    std::enable_if_t<std::is_integral<T>::value, LineBuffer&>
+    put(T value)
+    {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof digits, value);
+        buffer.append(digits, result.ptr);
+        return *this;
+    }
+
+    // Same as an ostream with the given precision and default float format.
+    LineBuffer& put(double value, int precision)
+    {
+        char digits[40];
+        int len = snprintf(digits, sizeof digits, "%.*g", precision, value);
+        buffer.append(digits, static_cast<size_t>(len));
+        return *this;
+    }
+};
+
+// Writes per-vertex algorithm results. Lines are formatted into large
+// buffers, in parallel for big outputs, and written in order without
+// flushing per line. In binary mode values are written as a raw
+// little-endian array after a header of magic "BLWRESLT", a uint32 version,
+// a uint32 value type tag (0/1: int32/uint32, 2/3: float/double, 4/5:
+// int64/uint64), and the uint64 value count.
+class ResultWriter {
+    static constexpr size_t chunkLines = 1 << 16;
+
+    std::ostream& out;
+    const bool binary;
+
+    template<typename T>
+    static constexpr uint32_t typeTag()
+    {
+        if (std::is_floating_point<T>::value) return sizeof(T) == 4 ? 2 : 3;
+        if (std::is_signed<T>::value) return sizeof(T) == 4 ? 0 : 4;
+        return sizeof(T) == 4 ? 1 : 5;
+    }
+
+    static void putLE(std::string& buffer, uint64_t value, size_t bytes)
+    {
+        for (size_t i = 0; i < bytes; i++) {
+            buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+        }
+    }
+
+    template<typename T, typename F>
+    void writeBinary(size_t count, F&& value)
+    {
+        static_assert(sizeof(T) == 4 || sizeof(T) == 8, "Unsupported type!");
+
+        std::string buffer("BLWRESLT");
+        putLE(buffer, 1, 4);
+        putLE(buffer, typeTag<T>(), 4);
+        putLE(buffer, count, 8);
+
+        for (size_t i = 0; i < count; i++) {
+            T val = value(i);
+            uint64_t bits = 0;
+            std::memcpy(&bits, &val, sizeof val);
+            putLE(buffer, bits, sizeof val);
+
+            if (buffer.size() >= chunkLines * sizeof val || i + 1 == count) {
+                out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
+            }
+        }
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        out.flush();
+    }
+
+  public:
+    ResultWriter(std::ostream& output, bool binaryOutput = false)
+      : out(output), binary(binaryOutput)
+    {}
+
+    // Calls format(buffer, i) for every line i in [0, count), formatting
+    // chunks of lines concurrently.
+    template<typename F>
+    void writeLines(size_t count, F&& format)
+    {
+        size_t threads = std::max(1U, std::thread::hardware_concurrency());
+        size_t chunks = (count + chunkLines - 1) / chunkLines;
+        std::vector<LineBuffer> buffers(std::min(chunks, 2 * threads));
+
+        for (size_t first = 0; first < chunks; first += buffers.size()) {
+            size_t batch = std::min(buffers.size(), chunks - first);
+            parallel_blocks(batch, [&](uint64_t b) {
+                auto& buffer = buffers[b];
+                size_t start = (first + b) * chunkLines;
+                size_t end = std::min(count, start + chunkLines);
+
+                buffer.clear();
+                for (size_t i = start; i < end; i++) format(buffer, i);
+            });
+
+            for (size_t b = 0; b < batch; b++) {
+                auto& str = buffers[b].str();
+                out.write(str.data(), static_cast<std::streamsize>(str.size()));
+            }
+        }
+        out.flush();
+    }
+
+    // "<index>\t<value>" lines, floating point values use the given
+    // precision. Binary mode only writes the values.
+    template<typename C>
+    void writeIndexed(const C& values, size_t count, int precision = 6)
+    {
+        using T = std::remove_cv_t<std::remove_reference_t<decltype(values[0])>>;
+        if (binary) {
+            writeBinary<T>(count, [&](size_t i) { return values[i]; });
+            return;
+        }
+
+        writeLines(count, [&](LineBuffer& buffer, size_t i) {
+            buffer.put(i).put('\t');
+            if constexpr (std::is_floating_point<T>::value) {
+                buffer.put(static_cast<double>(values[i]), precision);
+            } else {
+                buffer.put(values[i]);
+            }
+            buffer.put('\n');
+        });
+    }
+
+    // One value per line.
+    template<typename T, typename F>
+    void writeValues(size_t count, F&& value)
+    {
+        if (binary) {
+            writeBinary<T>(count, value);
+            return;
+        }
+
+        writeLines(count, [&](LineBuffer& buffer, size_t i) {
+            buffer.put(static_cast<T>(value(i))).put('\n');
+        });
+    }
+};
+#endif
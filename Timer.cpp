@@ -1,17 +1,20 @@
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
+#include <unistd.h>
+
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <map>
+#include <mutex>
 #include <sstream>
 
 #include "Timer.hpp"
-
-template<> template<>
-double
-StatisticalSummary<TimerRegister::Timing>::toDouble
-(const TimerRegister::nanoseconds& v)
-{ return static_cast<double>(v.count()); }
+#include "utils/Util.hpp"
 
 namespace TimerRegister {
 using namespace std;
@@ -19,27 +22,59 @@ using namespace std;
     struct timer_state {
         timer_state(string timer_name, size_t count)
             : name(timer_name)
-            , timings(make_shared<vector<nanoseconds>>())
-        { timings->reserve(count);}
+            , timings(make_shared<Samples>(count))
+        {}
 
         timer_state(const timer_state& other)
             : name(other.name), timings(other.timings)
         {}
 
         string name;
-        shared_ptr<vector<nanoseconds>> timings;
+        shared_ptr<Samples> timings;
     };
 
 struct EpochState {
     string name;
     bool printed;
+    uint64_t start;
     vector<timer_state> timers;
 
     EpochState(const string &id)
-        : name(id), printed(false)
+        : name(id), printed(false), start(now())
     {}
 };
 
+struct TraceEvent {
+    const Samples *timer;
+    uint64_t begin, end;
+};
+
+struct TraceBuffer {
+    size_t thread;
+    vector<TraceEvent> events;
+};
+
+bool tracing = false;
+bool keep_samples = false;
+static mutex trace_lock;
+static vector<shared_ptr<TraceBuffer>> trace_buffers;
+
+static TraceBuffer& local_trace_buffer()
+{
+    thread_local shared_ptr<TraceBuffer> buffer;
+    if (!buffer) {
+        lock_guard<mutex> guard(trace_lock);
+        buffer = make_shared<TraceBuffer>();
+        buffer->thread = trace_buffers.size();
+        buffer->events.reserve(1 << 16);
+        trace_buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void trace(const Samples *timer, uint64_t begin, uint64_t end)
+{ local_trace_buffer().events.push_back({timer, begin, end}); }
+
 Timing::Timing() : Timing::Timing(nanoseconds(0))
 {}
 
@@ -168,13 +203,115 @@ Epoch::Epoch(const string& id, vector<TimerData>&& timer_data)
 
 static vector<EpochState> epochs;
 
+ClockSource clock_source = ClockSource::steady;
+static double nanos_per_tick = 1.0;
+static double overhead = 0.0;
+static bool subtract_overhead = false;
+
+static const char *clock_names[] = { "steady", "monotonic-raw", "tsc" };
+
 static void reportPrecision(std::ostream& out)
 {
-    out << "Timer results with precision: " << clock::period::den
-        << endl << endl;
+    out << "Timer results with precision: " << clock::period::den << endl;
+    out << "Clock source: " << clock_names[static_cast<int>(clock_source)]
+        << ", overhead: " << overhead << " ns"
+        << (subtract_overhead ? " (subtracted)" : "") << endl << endl;
 }
 
-static shared_ptr<vector<nanoseconds>>
+static bool invariant_tsc()
+{
+#if defined(__x86_64__)
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) return false;
+    return edx & (1 << 8);
+#else
+    return false;
+#endif
+}
+
+// Ticks of the TSC per nanosecond of CLOCK_MONOTONIC_RAW over 20 ms.
+static double calibrate_tsc()
+{
+    clock_source = ClockSource::monotonic_raw;
+    uint64_t startTime = now();
+    clock_source = ClockSource::tsc;
+    uint64_t startTicks = now();
+
+    uint64_t endTime, endTicks;
+    do {
+        endTicks = now();
+        clock_source = ClockSource::monotonic_raw;
+        endTime = now();
+        clock_source = ClockSource::tsc;
+    } while (endTime - startTime < 20000000);
+
+    return static_cast<double>(endTime - startTime)
+         / static_cast<double>(endTicks - startTicks);
+}
+
+// Median cost of back-to-back clock reads, in nanoseconds.
+static double calibrate_overhead()
+{
+    vector<uint64_t> diffs(10001);
+    for (auto& diff : diffs) {
+        uint64_t begin = now();
+        diff = now() - begin;
+    }
+
+    nth_element(diffs.begin(), diffs.begin() + diffs.size() / 2, diffs.end());
+    return static_cast<double>(diffs[diffs.size() / 2]) * nanos_per_tick;
+}
+
+void set_clock(ClockSource source, bool subtractOverhead)
+{
+    nanos_per_tick = 1.0;
+    if (source == ClockSource::tsc && !invariant_tsc()) {
+        cerr << "No invariant TSC, using monotonic-raw clock." << endl;
+        source = ClockSource::monotonic_raw;
+    }
+
+    if (source == ClockSource::tsc) nanos_per_tick = calibrate_tsc();
+
+    clock_source = source;
+    subtract_overhead = subtractOverhead;
+    overhead = calibrate_overhead();
+}
+
+ClockSource parse_clock(const string& name)
+{
+    for (int i = 0; i < 3; i++) {
+        if (name == clock_names[i]) return static_cast<ClockSource>(i);
+    }
+    reportError("Unknown clock source: ", name);
+}
+
+double timer_overhead()
+{ return overhead; }
+
+Samples::Samples(size_t capacity)
+    : pending(std::min<size_t>(std::max<size_t>(capacity, 16), 4096))
+    , used(0)
+{ summary.reserve(capacity); }
+
+void Samples::reserve(size_t count)
+{
+    flush();
+    if (count > pending.size()) pending.resize(std::min<size_t>(count, 4096));
+    summary.reserve(summary.size() + count);
+}
+
+void Samples::flush()
+{
+    for (size_t i = 0; i < used; i++) {
+        double time = static_cast<double>(pending[i]) * nanos_per_tick;
+        if (subtract_overhead) time = std::max(0.0, time - overhead);
+        summary.add(time);
+        if (keep_samples) samples.push_back(time);
+    }
+    used = 0;
+}
+
+static shared_ptr<Samples>
 register_timer(string name, size_t count)
 {
     auto &timers = epochs.back().timers;
@@ -190,7 +327,8 @@ vector<Epoch> get_epochs()
         if (state.timers.empty()) continue;
         vector<Epoch::TimerData> timer_data;
         for (auto data : state.timers) {
-            timer_data.emplace_back(data.name, StatisticalSummary<Timing>(*data.timings));
+            data.timings->flush();
+            timer_data.emplace_back(data.name, data.timings->summary.summary());
         }
         result.emplace_back(state.name, move(timer_data));
     }
@@ -209,7 +347,7 @@ registerEpoch(const std::string& name)
 
 Epoch::Epoch(bool humanReadable, const std::string& name)
     : direct_printed(false), human_readable(humanReadable)
-    , output("/dev/null"), index(registerEpoch(name))
+    , output("/dev/null"), index(registerEpoch(name)), binary(false)
 {}
 
 Epoch::Epoch
@@ -217,7 +355,7 @@ Epoch::Epoch
     , bool humanReadable
     , const std::string& name)
     : direct_printed(true), human_readable(humanReadable)
-    , output(std::move(timingFile)), index(registerEpoch(name))
+    , output(std::move(timingFile)), index(registerEpoch(name)), binary(false)
 {}
 
 Epoch::Epoch
@@ -242,7 +380,17 @@ Epoch::Epoch
 {}
 
 Epoch::~Epoch()
-{ if (direct_printed) print_results(output, human_readable); }
+{
+    if (direct_printed && binary) write_binary(output);
+    else if (direct_printed) print_results(output, human_readable);
+    TimerRegister::keep_samples = false;
+
+    if (!trace_file.empty()) {
+        std::ofstream trace(trace_file);
+        write_trace(trace);
+        TimerRegister::tracing = false;
+    }
+}
 
 void
 Epoch::set_output(const std::string& fileName)
@@ -262,8 +410,9 @@ Epoch::print_results(std::ostream& out, bool humanReadable)
     if (humanReadable) TimerRegister::reportPrecision(output);
 
     for (auto &timer : epoch.timers) {
-        if (!timer.timings->empty()) {
-            StatisticalSummary<Timing> result(*timer.timings);
+        timer.timings->flush();
+        if (!timer.timings->summary.empty()) {
+            StatisticalSummary<Timing> result = timer.timings->summary.summary();
             if (!epoch.name.empty() && epoch.name != "") {
                 out << epoch.name << ":";
             }
@@ -276,7 +425,7 @@ Epoch::print_results(std::ostream& out, bool humanReadable)
                     , { "Std", result.stdDev }
                 });
 
-                out << timer.name << " (" << timer.timings->size() << "): "
+                out << timer.name << " (" << timer.timings->summary.size() << "): "
                     << std::endl;
 
                 for (auto &str : times) {
@@ -295,21 +444,121 @@ Epoch::print_results(std::ostream& out, bool humanReadable)
 }
 
 Timer::Timer(const std::string& name, size_t count)
-    : timings(TimerRegister::register_timer(name, count))
+    : begin(0), pauseBegin(0), paused(0)
+    , timings(TimerRegister::register_timer(name, count))
 {}
 
 void
-Timer::start()
-{ begin = TimerRegister::clock::now(); }
+Timer::reserve(size_t count)
+{ timings->reserve(count); }
 
 void
-Timer::stop()
-{ timings->push_back(TimerRegister::clock::now() - begin); }
+Epoch::set_trace(const std::string& fileName)
+{
+    trace_file = fileName;
+    TimerRegister::tracing = !trace_file.empty();
+}
 
 void
-Timer::reserve(size_t count)
+Epoch::write_trace(std::ostream& out)
+{
+    using namespace TimerRegister;
+    auto& epoch = epochs[index];
+
+    std::map<const Samples*, std::string> names;
+    for (auto& timer : epoch.timers) {
+        std::string name = epoch.name.empty() ? timer.name
+                                              : epoch.name + ":" + timer.name;
+        std::string escaped;
+        for (char c : name) {
+            if (c == '"' || c == '\\') escaped += '\\';
+            escaped += c;
+        }
+        names.emplace(timer.timings.get(), escaped);
+    }
+
+    auto micros = [&](uint64_t from, uint64_t to) {
+        auto ticks = static_cast<int64_t>(to - from);
+        return static_cast<double>(ticks) * nanos_per_tick / 1000;
+    };
+
+    out.imbue(std::locale("C"));
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    bool first = true;
+    std::lock_guard<std::mutex> guard(trace_lock);
+    for (auto& buffer : trace_buffers) {
+        for (auto& event : buffer->events) {
+            auto name = names.find(event.timer);
+            if (name == names.end()) continue;
+
+            out << (first ? "\n" : ",\n");
+            first = false;
+            out << "{\"name\":\"" << name->second << "\",\"cat\":\"timer\""
+                << ",\"ph\":\"X\",\"pid\":" << getpid()
+                << ",\"tid\":" << buffer->thread
+                << ",\"ts\":" << micros(epoch.start, event.begin)
+                << ",\"dur\":" << micros(event.begin, event.end) << "}";
+        }
+        buffer->events.clear();
+    }
+    out << "\n]}" << std::endl;
+}
+
+void
+Epoch::set_binary(bool enable)
 {
-    if (timings->capacity() - timings->size() < count) {
-        timings->reserve(timings->size() + std::max(count, 100UL));
+    binary = enable;
+    TimerRegister::keep_samples = enable;
+}
+
+void
+Epoch::write_binary(std::ostream& out)
+{
+    static_assert(sizeof(double) == 8, "Binary timings require 64-bit doubles!");
+
+    auto& epoch = TimerRegister::epochs[index];
+
+    auto write = [&](const void *data, size_t size) {
+        out.write(static_cast<const char*>(data),
+                  static_cast<std::streamsize>(size));
+    };
+
+    // Little-endian regardless of the host.
+    auto put = [&](uint64_t value, size_t bytes) {
+        unsigned char buffer[8];
+        for (size_t i = 0; i < bytes; i++) buffer[i] = (value >> (8 * i)) & 0xff;
+        write(buffer, bytes);
+    };
+
+    uint32_t count = 0;
+    for (auto& timer : epoch.timers) {
+        timer.timings->flush();
+        if (!timer.timings->samples.empty()) count++;
+    }
+
+    write("BLWTIMES", 8);
+    put(1, 4);
+    put(count, 4);
+
+    for (auto& timer : epoch.timers) {
+        auto& samples = timer.timings->samples;
+        if (samples.empty()) continue;
+
+        std::string name = epoch.name.empty() ? timer.name
+                                              : epoch.name + ":" + timer.name;
+        put(name.size(), 4);
+        put(0, 4);
+        put(samples.size(), 8);
+        write(name.data(), name.size());
+        put(0, (8 - name.size() % 8) % 8);
+
+        for (double sample : samples) {
+            uint64_t bits;
+            memcpy(&bits, &sample, sizeof bits);
+            put(bits, 8);
+        }
     }
+    out.flush();
 }
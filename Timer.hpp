@@ -1,7 +1,10 @@
 #ifndef TIMER_HPP
 #define TIMER_HPP
 
+#include <time.h>
+
 #include <chrono>
+#include <cstdint>
 #include <fstream>
 #include <memory>
 #include <string>
@@ -48,6 +51,64 @@ namespace TimerRegister {
     };
 
     vector<Epoch> get_epochs();
+
+    enum class ClockSource { steady, monotonic_raw, tsc };
+
+    // Selects the clock read by all timers, calibrates the TSC frequency
+    // (when used) and the overhead of a start/stop pair, which is subtracted
+    // from every sample if requested. Must be called before timers run.
+    void set_clock(ClockSource source, bool subtractOverhead = false);
+    ClockSource parse_clock(const string& name);
+    double timer_overhead();
+
+    extern ClockSource clock_source;
+
+    inline uint64_t now()
+    {
+#if defined(__x86_64__)
+        if (clock_source == ClockSource::tsc) {
+            __builtin_ia32_lfence();
+            return __builtin_ia32_rdtsc();
+        }
+#endif
+        if (clock_source == ClockSource::monotonic_raw) {
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+            return static_cast<uint64_t>(ts.tv_sec) * 1000000000
+                 + static_cast<uint64_t>(ts.tv_nsec);
+        }
+
+        auto time = clock::now().time_since_epoch();
+        return static_cast<uint64_t>(duration_cast<chrono::nanoseconds>(time).count());
+    }
+
+    // Fixed capacity buffer of raw clock readings, only folded into the
+    // summary when full or when results are requested, so that stopping a
+    // timer doesn't allocate.
+    struct Samples {
+        Samples(size_t capacity);
+
+        void add(uint64_t ticks)
+        {
+            if (used == pending.size()) flush();
+            pending[used++] = ticks;
+        }
+
+        void reserve(size_t count);
+        void flush();
+
+        StreamingSummary<Timing> summary;
+        vector<double> samples;
+        vector<uint64_t> pending;
+        size_t used;
+    };
+
+    // Whether all samples are kept (in nanoseconds) for binary output.
+    extern bool keep_samples;
+
+    // Whether timer intervals are recorded for an Epoch's trace file.
+    extern bool tracing;
+    void trace(const Samples *timer, uint64_t begin, uint64_t end);
 };
 
 class Epoch
@@ -90,11 +151,27 @@ class Epoch
 
         void print_results(std::ostream&, bool humanReadable = false);
 
+        // Records every timer interval of this epoch and writes them as a
+        // Chrome trace (also loadable by Perfetto) when the epoch ends.
+        void set_trace(const std::string&);
+        void write_trace(std::ostream&);
+
+        // Write every raw sample in a versioned binary format instead of the
+        // text summary. All values are little-endian: magic "BLWTIMES", a
+        // uint32 version (1) and uint32 timer count, then per timer a uint32
+        // name length, uint32 0, uint64 sample count, the name zero padded
+        // to a multiple of 8 bytes, and the samples in nanoseconds as doubles.
+        // Read by benchmark-analysis/cbits/timing_file.c.
+        void set_binary(bool);
+        void write_binary(std::ostream&);
+
     private:
+        std::string trace_file;
         bool direct_printed;
         bool human_readable;
         std::ofstream output;
         size_t index;
+        bool binary;
 };
 
 class Timer
@@ -104,12 +181,39 @@ class Timer
         Timer(const Timer&) = delete;
         Timer(Timer&&) = default;
 
-        void start();
-        void stop();
+        void start()
+        {
+            paused = 0;
+            begin = TimerRegister::now();
+        }
+
+        // Excludes the time between pause() and resume() from the measured
+        // interval, apart from the given ticks measured in the meantime.
+        void pause()
+        { pauseBegin = TimerRegister::now(); }
+
+        void resume(uint64_t counted = 0)
+        { paused += TimerRegister::now() - pauseBegin - counted; }
+
+        // Returns the measured interval, in clock ticks.
+        uint64_t stop()
+        {
+            uint64_t end = TimerRegister::now();
+            timings->add(end - begin - paused);
+            if (TimerRegister::tracing) {
+                TimerRegister::trace(timings.get(), begin, end);
+            }
+            return end - begin - paused;
+        }
+
+        // Records an interval measured elsewhere, in clock ticks.
+        void add(uint64_t ticks)
+        { timings->add(ticks); }
+
         void reserve(size_t);
 
     private:
-        TimerRegister::clock::time_point begin;
-        std::shared_ptr<std::vector<TimerRegister::nanoseconds>> timings;
+        uint64_t begin, pauseBegin, paused;
+        std::shared_ptr<TimerRegister::Samples> timings;
 };
 #endif
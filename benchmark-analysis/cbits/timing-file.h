@@ -0,0 +1,46 @@
+#ifndef TIMING_FILE_H
+#define TIMING_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Binary timing files written by kernel-runner's --binary-timings. All
+ * integers and doubles are little-endian:
+ *
+ *   char[8]  magic "BLWTIMES"
+ *   uint32   version (1)
+ *   uint32   timer count
+ *
+ * followed by, for each timer:
+ *
+ *   uint32   name length
+ *   uint32   reserved (0)
+ *   uint64   sample count
+ *   char[]   name, zero padded to a multiple of 8 bytes
+ *   double[] samples, in nanoseconds
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct timing_series {
+    char *name;
+    uint64_t count;
+    double *samples;
+};
+
+struct timing_file {
+    uint32_t version;
+    uint32_t timer_count;
+    struct timing_series *timers;
+};
+
+/* Returns 0 on success, -1 if the file can't be read or is malformed. */
+int read_timing_file(const char *path, struct timing_file *result);
+void free_timing_file(struct timing_file *file);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "timing-file.h"
+
+static const char magic[8] = { 'B', 'L', 'W', 'T', 'I', 'M', 'E', 'S' };
+
+static int read_le(FILE *file, uint64_t *result, size_t bytes)
+{
+    unsigned char buffer[8];
+    if (fread(buffer, 1, bytes, file) != bytes) return -1;
+
+    *result = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        *result |= (uint64_t) buffer[i] << (8 * i);
+    }
+    return 0;
+}
+
+static int read_series(FILE *file, struct timing_series *series)
+{
+    uint64_t nameLength, reserved, count;
+    if (read_le(file, &nameLength, 4)) return -1;
+    if (read_le(file, &reserved, 4)) return -1;
+    if (read_le(file, &count, 8)) return -1;
+
+    series->name = calloc(nameLength + 1, 1);
+    if (!series->name) return -1;
+    if (fread(series->name, 1, nameLength, file) != nameLength) return -1;
+    if (fseek(file, (long) ((8 - nameLength % 8) % 8), SEEK_CUR)) return -1;
+
+    if (count > SIZE_MAX / sizeof *series->samples) return -1;
+    series->samples = malloc(count ? count * sizeof *series->samples : 1);
+    if (!series->samples) return -1;
+
+    if (fread(series->samples, sizeof *series->samples, count, file) != count) {
+        return -1;
+    }
+    series->count = count;
+
+    /* Samples are stored little-endian, decode them in place. */
+    for (uint64_t i = 0; i < count; i++) {
+        unsigned char *bytes = (unsigned char *) &series->samples[i];
+        uint64_t bits = 0;
+        for (size_t j = 0; j < 8; j++) bits |= (uint64_t) bytes[j] << (8 * j);
+        memcpy(&series->samples[i], &bits, sizeof bits);
+    }
+    return 0;
+}
+
+int read_timing_file(const char *path, struct timing_file *result)
+{
+    char header[8];
+    uint64_t version, count;
+
+    memset(result, 0, sizeof *result);
+
+    FILE *file = fopen(path, "rb");
+    if (!file) return -1;
+
+    if (fread(header, 1, sizeof header, file) != sizeof header
+        || memcmp(header, magic, sizeof magic)
+        || read_le(file, &version, 4) || version != 1
+        || read_le(file, &count, 4)) {
+        fclose(file);
+        return -1;
+    }
+
+    result->version = (uint32_t) version;
+    result->timers = calloc(count ? count : 1, sizeof *result->timers);
+    if (!result->timers) {
+        fclose(file);
+        return -1;
+    }
+
+    for (uint64_t i = 0; i < count; i++) {
+        result->timer_count = (uint32_t) i + 1;
+        if (read_series(file, &result->timers[i])) {
+            fclose(file);
+            free_timing_file(result);
+            return -1;
+        }
+    }
+
+    fclose(file);
+    return 0;
+}
+
+void free_timing_file(struct timing_file *file)
+{
+    for (uint32_t i = 0; i < file->timer_count; i++) {
+        free(file->timers[i].name);
+        free(file->timers[i].samples);
+    }
+    free(file->timers);
+    memset(file, 0, sizeof *file);
+}
@@ -40,6 +40,7 @@ import Schema
 import Sql (MonadSql, Region, Transaction, (=.))
 import qualified Sql
 import qualified Sql.Transaction as SqlTrans
+import TimingFile (readTimingFile)
 
 computeHash :: MonadIO m => FilePath -> m Hash
 computeHash path = do
@@ -128,7 +129,7 @@ processProperty result@Result
   } = do
     logDebugNS "Property#Start" resultLabel
     ProcessPool.cleanupTimings result
-    resultHash <- computeHash outputFile
+    resultHash <- maybe (computeHash outputFile) return resultDigest
 
     SqlTrans.tryAbortableTransaction $ do
         loadProps <- case hash of
@@ -226,7 +227,8 @@ processTiming
 processTiming runConfigId commit result@Result{..} = do
     logDebugNS "Timing#Start" resultLabel
     time <- liftIO getCurrentTime
-    resultHash <- computeHash outputFile
+    resultHash <- maybe (computeHash outputFile) return resultDigest
+    timers <- liftIO $ readTimingFile timingFile
     ProcessPool.cleanupProperties result
     ProcessPool.cleanupOutput result
 
@@ -250,19 +252,18 @@ processTiming runConfigId commit result@Result{..} = do
                 , " for run config #", showSqlKey runConfigId
                 ]
 
-        runConduit $
-            C.sourceFile timingFile
-            .| C.decode C.utf8
-            .| C.map (T.replace "," "")
-            .| conduitParse timer
-            .| C.mapM_ (insertTiming runId)
+        case timers of
+            Nothing -> SqlTrans.abortTransaction $
+                "Failed to read timing file: " <> T.pack timingFile
+            Just samples ->
+                mapM_ (insertTiming runId . uncurry sampleTimer) samples
 
         logDebugNS "Timing#End" resultLabel
 
     ProcessPool.cleanupTimings result
   where
     (algoId, implId, hash, maxStep) = resultValue
-    timingFile = T.unpack resultLabel <> ".timings"
+    (timingFile, _) = resultTimings
     outputFile = T.unpack resultLabel <> ".output"
 
     insertTiming
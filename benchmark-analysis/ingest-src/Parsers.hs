@@ -9,6 +9,7 @@ module Parsers
     , property
     , timer
     , externalResult
+    , sampleTimer
     ) where
 
 import Control.Applicative ((<|>))
@@ -83,6 +84,32 @@ timing = do
     stddev <- double <* endOfLine
     return Timing{..}
 
+-- | Summarises the raw samples of a timer from a binary timing file the same
+-- way kernel-runner's text timing output does.
+sampleTimer :: Text -> [Double] -> Timer
+sampleTimer fullName samples = case parseOnly stepName fullName of
+    Right (step, timerName) -> StepTiming step (summary timerName)
+    Left _ -> TotalTiming (summary fullName)
+  where
+    stepName :: Parser (Int, Text)
+    stepName = (,) <$> decimal <* char ':' <*> takeText
+
+    summary :: Text -> Timing
+    summary timerName =
+        Timing timerName (minimum samples) mean (maximum samples) stdDev
+
+    count :: Double
+    count = fromIntegral (length samples)
+
+    mean :: Double
+    mean = sum samples / count
+
+    stdDev :: Double
+    stdDev
+        | count < 2 = 0
+        | otherwise = sqrt $ sum [(x - mean) ^ (2 :: Int) | x <- samples]
+                           / (count - 1)
+
 externalResult :: Parser ExternalResult
 externalResult = do
     name <- takeWhile1 (/=':') <* char ':'
@@ -26,6 +26,7 @@ import Control.Monad.Logger (Loc, LogLevel, LogSource, LogStr, LoggingT)
 import qualified Control.Monad.Logger as Log
 import Control.Monad.Trans.Resource (ReleaseKey, allocate, register, release)
 import Data.Acquire (withAcquire, mkAcquireType, ReleaseType(ReleaseException))
+import Data.ByteArray.Encoding (Base(Base16), convertFromBase)
 import qualified Data.ByteString as BS
 import qualified Data.ByteString.Lazy as LBS
 import qualified Data.ByteString.Builder as BS
@@ -34,6 +35,7 @@ import Data.Maybe (fromMaybe)
 import Data.Pool (Pool)
 import qualified Data.Pool as Pool
 import qualified Data.Text as T
+import qualified Data.Text.Encoding as T
 import qualified Data.Text.IO as T
 import qualified Data.Time.LocalTime as Time
 import Data.Time.Calendar (DayOfWeek(Saturday,Sunday), dayOfWeek)
@@ -105,6 +107,7 @@ data Result a = Result
     , resultLabel :: Text
     , resultAlgorithmVersion :: CommitId
     , resultOutput :: (FilePath, ReleaseKey)
+    , resultDigest :: Maybe Hash
     , resultTimings :: (FilePath, ReleaseKey)
     , resultPropLog :: Maybe (FilePath, ReleaseKey)
     } deriving (Functor, Foldable, Traversable)
@@ -232,7 +235,7 @@ withProcessPool n Platform{platformName,platformFlags} f = do
         exePath <- getKernelExecutable
         libPath <- getKernelLibPath
         proc@Process{procId,errHandle} <- liftIO $ do
-            runnerProc <- createRunnerProc [exePath, "-L", libPath, "-W", "-S"]
+            runnerProc <- createRunnerProc [exePath, "-L", libPath, "-W", "-D", "-b", "-S"]
 
             let p = runnerProc
                     { std_in = CreatePipe
@@ -313,7 +316,7 @@ processJobsParallelWithSharedPool numNodes procPool =
 
         let fileStem = T.unpack jobLabel
             outputFile = fileStem <.> "output"
-            timingFile = fileStem <.> "timings"
+            timingFile = fileStem <.> "timings" <.> "bin"
             logFile = fileStem <.> "log"
 
             handleErrors act = act `onError` do
@@ -331,10 +334,16 @@ processJobsParallelWithSharedPool numNodes procPool =
                     T.hPutStrLn inHandle jobCommand
                     T.hGetLine outHandle
 
-                let (label, commit) = case T.splitOn ":" result of
+                let (header, digestText) = T.breakOn "\t" result
+                    (label, commit) = case T.splitOn ":" header of
                         (version:rest) -> (T.concat rest, version)
                         [] -> ("", "")
 
+                    hexDigest = T.encodeUtf8 . T.strip $ T.drop 1 digestText
+                    digest = case convertFromBase Base16 hexDigest of
+                        Right bytes | not (BS.null bytes) -> Just (Hash bytes)
+                        _ -> Nothing
+
                 logDebugNS "Process#Job#End" jobCommand
                 outputKey <- registerFile outputFile
                 timingKey <- registerFile timingFile
@@ -350,6 +359,7 @@ processJobsParallelWithSharedPool numNodes procPool =
                     , resultLabel = label
                     , resultAlgorithmVersion = CommitId commit
                     , resultOutput = outputKey
+                    , resultDigest = digest
                     , resultTimings = timingKey
                     , resultPropLog = logKey
                     }
@@ -83,15 +83,20 @@ reportModelStats ModelStats{..} = do
 exportPredictor :: ExportType -> Maybe FilePath -> PredictorConfig -> SqlM ()
 exportPredictor exportType exportOutput predConfig = do
     predictor <- loadPredictor predConfig
-    modelSrc <- predictorToCxx predictor
 
     let predName = rawPredictorName predictor
 
     case exportType of
-        CppFile -> liftIO $ LT.writeFile (outputFile predName) modelSrc
+        CppFile -> do
+            modelSrc <- predictorToCxx predictor
+            liftIO $ LT.writeFile (outputFile predName) modelSrc
         SharedLib -> do
+            modelSrc <- predictorToCxx predictor
             cxxWrapper <- getCxxCompilerWrapper (outputFile predName)
             withStdin cxxWrapper $ \hnd -> liftIO $ LT.hPutStr hnd modelSrc
+        TreeFile -> do
+            modelTree <- predictorToTree predictor
+            liftIO $ LT.writeFile (outputFile predName) modelTree
   where
     outputFile :: Text -> FilePath
     outputFile modelName = case exportOutput of
@@ -102,6 +107,7 @@ exportPredictor exportType exportOutput predConfig = do
     fileSuffix = case exportType of
         SharedLib -> ".so"
         CppFile -> ".cpp"
+        TreeFile -> ".tree"
 
 main :: IO ()
 main = runCommand commands $ \case
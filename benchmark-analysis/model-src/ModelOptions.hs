@@ -57,7 +57,7 @@ import Query.Train
 import qualified Query.Train as Train
 import Query.Variant
 
-data ExportType = CppFile | SharedLib
+data ExportType = CppFile | SharedLib | TreeFile
 
 data ModelCommand
     = Train
@@ -211,6 +211,15 @@ commands = CommandRoot
         }
         $ PredictorExport CppFile <$> predictorConfigParser
                                   <*> optional cppFile
+    , SingleCommand CommandInfo
+        { commandName = "export-tree"
+        , commandHeaderDesc = "export model decision tree"
+        , commandDesc =
+            "Export BDT model as a decision tree file, evaluated by \
+            \kernel-runner without compiling it"
+        }
+        $ PredictorExport TreeFile <$> predictorConfigParser
+                                   <*> optional treeFile
     , SingleCommand CommandInfo
         { commandName = "multi-export"
         , commandHeaderDesc = "export multiple models"
@@ -223,6 +232,12 @@ commands = CommandRoot
         , commandDesc = "Export multiple BDT models to C++ source"
         }
         $ MultiPredictorExport CppFile <$> predictorConfigsParser
+    , SingleCommand CommandInfo
+        { commandName = "multi-export-tree"
+        , commandHeaderDesc = "export multiple model decision trees"
+        , commandDesc = "Export multiple BDT models as decision tree files"
+        }
+        $ MultiPredictorExport TreeFile <$> predictorConfigsParser
     ]
   }
   where
@@ -234,6 +249,10 @@ commands = CommandRoot
     cppFile = strArgument . mconcat $
         [ metavar "FILE", help "C++ file to write predictor to." ]
 
+    treeFile :: Parser FilePath
+    treeFile = strArgument . mconcat $
+        [ metavar "FILE", help "File to write decision tree to." ]
+
 getGraphProps :: SqlM (Map Text (Key PropertyName))
 getGraphProps = Sql.selectSource [PropertyNameIsStepProp ==. False] [] $
     C.foldMap propMap
@@ -17,6 +17,7 @@ module Predictor
     , cookPredictor
     , getPredictorConfigAlgorithmId
     , predictorToCxx
+    , predictorToTree
     , loadPredictor
     , predict
     , predictCooked
@@ -34,7 +35,7 @@ import Core
 import qualified Model
 import Model.Stats (ModelStats(..), UnknownSet(..), getModelStats)
 import Predictor.Config
-import Predictor.Raw (RawPredictor(..), predictorToCxx)
+import Predictor.Raw (RawPredictor(..), predictorToCxx, predictorToTree)
 import Schema
 import Sql (MonadSql, SqlBackend, SqlRecord, ToBackendKey)
 import qualified Sql
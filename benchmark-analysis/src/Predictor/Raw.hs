@@ -3,14 +3,13 @@
 {-# LANGUAGE OverloadedStrings #-}
 {-# LANGUAGE QuasiQuotes #-}
 {-# LANGUAGE RecordWildCards #-}
-module Predictor.Raw (RawPredictor(..), predictorToCxx) where
+module Predictor.Raw (RawPredictor(..), predictorToCxx, predictorToTree) where
 
 import qualified Data.Conduit.Combinators as C
 import Data.Foldable (fold)
 import Data.List (intersperse)
 import Data.Map.Strict (Map)
 import qualified Data.Map.Strict as M
-import Data.Monoid (Sum(..))
 import Data.String.Interpolate.IsString (i)
 import qualified Data.Text as T
 import qualified Data.Text.Lazy as LT
@@ -86,67 +85,100 @@ extern "C" int32_t lookup()
 }
 |]
 
-mkPropertyMapping :: Key PredictionModel -> SqlM Builder
-mkPropertyMapping modelId = do
-    (Sum numProps, propEntries) <-
-        Sql.selectSource propFilter [] $ C.foldMapM (mkPropIdx . entityVal)
+-- | Plain text predictor description, evaluated in-process by the switch
+-- implementations without compiling a shared library. Every line is a
+-- keyword followed by its fields, names last as they may contain spaces.
+predictorToTree :: RawPredictor -> SqlM LT.Text
+predictorToTree RawPredictor{..} = toLazyText <$> do
+    props <- modelProperties rawPredictorId
 
-    return $ [i|
-static double properties[#{numProps}];
+    let (nodes, newLabels) = relabelNodes rawPredictorModel
+                                 rawPredictorMispredictionStrategy
 
-extern "C" const std::map<std::string,std::reference_wrapper<double>> propNames;
-extern "C" const std::map<std::string,std::reference_wrapper<double>>
-propNames = {
-|] <> propEntries <> [i|};|]
+    impls <- implConfigs newLabels
+
+    let defaultImpl = newLabels M.! toSqlKey (fromIntegral rawPredictorDefaultImpl)
+
+    return $ mconcat
+        [ "belewitte-tree 1\n"
+        , "name ", fromText rawPredictorName, "\n"
+        , "default ", decimal defaultImpl, "\n"
+        , foldMap propLine props
+        , foldMap implLine impls
+        , foldMap nodeLine nodes
+        ]
+  where
+    propLine :: (Text, Int) -> Builder
+    propLine (name, idx) = mconcat
+        [ "property ", decimal idx, " ", fromText name, "\n" ]
+
+    implLine :: (Text, Key Implementation, Int, Int, Int) -> Builder
+    implLine (kernelName, implId, idx, warp, chunk) = mconcat
+        [ "implementation ", decimal idx, " ", fromText (showSqlKey implId)
+        , " ", decimal warp, " ", decimal chunk, " ", fromText kernelName
+        , "\n"
+        ]
+
+    nodeLine :: TreeNode -> Builder
+    nodeLine Node{..} = mconcat
+        [ "node ", realFloat threshold, " ", decimal propIdx, " "
+        , decimal leftNode, " ", decimal rightNode, "\n"
+        ]
+
+modelProperties :: Key PredictionModel -> SqlM [(Text, Int)]
+modelProperties modelId =
+    Sql.selectSource propFilter [] $ C.foldMapM (mkPropIdx . entityVal)
   where
     propFilter :: [Filter ModelProperty]
     propFilter = [ModelPropertyModelId ==. modelId]
 
-    mkPropIdx :: ModelProperty -> SqlM (Sum Int, Builder)
+    mkPropIdx :: ModelProperty -> SqlM [(Text, Int)]
     mkPropIdx ModelProperty{..} = do
         name <- propertyNameProperty <$> Sql.getJust modelPropertyPropId
-        return (Sum 1, propEntry name)
-      where
-        propEntry :: Text -> Builder
-        propEntry propName = mconcat
-            [ "    { \"", fromText propName
-            , "\", std::ref(properties[", decimal modelPropertyPropertyIdx
-            , "]) },\n"
-            ]
+        return [(name, modelPropertyPropertyIdx)]
 
-mkImplMapping :: Map (Key Implementation) Int -> Int -> SqlM Builder
-mkImplMapping implIndices defImpl = do
-    implEntries <- fold <$> M.traverseWithKey lookupName implIndices
-
-    let defaultImpl = implIndices M.! toSqlKey (fromIntegral defImpl)
+mkPropertyMapping :: Key PredictionModel -> SqlM Builder
+mkPropertyMapping modelId = do
+    props <- modelProperties modelId
 
     return $ [i|
-extern "C" const int32_t default_impl;
-extern "C" const int32_t default_impl = #{defaultImpl};
+static double properties[#{length props}];
 
-extern "C" const std::vector<std::tuple<std::string,int64_t,size_t,size_t,size_t>> implNames;
-extern "C" const std::vector<std::tuple<std::string,int64_t,size_t,size_t,size_t>>
-implNames = {
-|] <> implEntries <> [i|};|]
+extern "C" const std::map<std::string,std::reference_wrapper<double>> propNames;
+extern "C" const std::map<std::string,std::reference_wrapper<double>>
+propNames = {
+|] <> foldMap propEntry props <> [i|};|]
+  where
+    propEntry :: (Text, Int) -> Builder
+    propEntry (propName, propIdx) = mconcat
+        [ "    { \"", fromText propName
+        , "\", std::ref(properties[", decimal propIdx
+        , "]) },\n"
+        ]
+
+implConfigs
+    :: Map (Key Implementation) Int
+    -> SqlM [(Text, Key Implementation, Int, Int, Int)]
+implConfigs = fmap fold . M.traverseWithKey lookupName
   where
-    lookupName :: Key Implementation -> Int -> SqlM Builder
+    lookupName
+        :: Key Implementation
+        -> Int
+        -> SqlM [(Text, Key Implementation, Int, Int, Int)]
     lookupName implId idx = do
         implName <- implementationName <$> Sql.getJust implId
-        let (kernelName, warpConfig) = kernelConfig implName
-        return $ mconcat
-            [ "    std::make_tuple( \"" , kernelName , "\", " 
-            , fromText (showSqlKey implId), ", ", decimal idx
-            , ", ", warpConfig, " ),\n" ]
+        let (kernelName, warp, chunk) = kernelConfig implName
+        return [(kernelName, implId, idx, warp, chunk)]
 
-    kernelConfig :: Text -> (Builder, Builder)
+    kernelConfig :: Text -> (Text, Int, Int)
     kernelConfig implName
         | "-warp-" `T.isInfixOf` implName
         , Just warp <- readMaybe (T.unpack warpTxt) :: Maybe Int
         , Just chunk <- readMaybe (T.unpack chunkTxt) :: Maybe Int
-        = (fromText newName, decimal warp <> ", " <> decimal chunk)
+        = (newName, warp, chunk)
         | "-warp-" `T.isInfixOf` implName || "-warp" `T.isSuffixOf` implName
-        = (fromText implName, "32, 32")
-        | otherwise = (fromText implName, "0, 0")
+        = (implName, 32, 32)
+        | otherwise = (implName, 0, 0)
       where
         chunks = T.split (=='-') implName
 
@@ -156,36 +188,67 @@ implNames = {
 
         newName = T.intercalate "-" . reverse $ revRemainder
 
+mkImplMapping :: Map (Key Implementation) Int -> Int -> SqlM Builder
+mkImplMapping implIndices defImpl = do
+    implEntries <- foldMap implEntry <$> implConfigs implIndices
+
+    let defaultImpl = implIndices M.! toSqlKey (fromIntegral defImpl)
+
+    return $ [i|
+extern "C" const int32_t default_impl;
+extern "C" const int32_t default_impl = #{defaultImpl};
+
+extern "C" const std::vector<std::tuple<std::string,int64_t,size_t,size_t,size_t>> implNames;
+extern "C" const std::vector<std::tuple<std::string,int64_t,size_t,size_t,size_t>>
+implNames = {
+|] <> implEntries <> [i|};|]
+  where
+    implEntry :: (Text, Key Implementation, Int, Int, Int) -> Builder
+    implEntry (kernelName, implId, idx, warp, chunk) = mconcat
+        [ "    std::make_tuple( \"" , fromText kernelName, "\", "
+        , fromText (showSqlKey implId), ", ", decimal idx
+        , ", ", decimal warp, ", ", decimal chunk, " ),\n" ]
+
 relabelDecisionTree
     :: Model -> (Int -> Int) -> (Builder, Map (Key Implementation) Int)
-relabelDecisionTree (Model tree) mispredictionStrategy =
-    (decisionTree, newLabels)
+relabelDecisionTree model mispredictionStrategy = (decisionTree, newLabels)
   where
-    (array, newLabels) = VS.foldl' relabel (mempty, M.empty) tree
+    (nodes, newLabels) = relabelNodes model mispredictionStrategy
+
+    decisionTree = "\nstatic tree_t tree[] = {\n" <> foldMap treeRow nodes <> "};"
 
-    decisionTree = "\nstatic tree_t tree[] = {\n" <> array <> "};"
+    treeRow :: TreeNode -> Builder
+    treeRow Node{..} = mconcat
+        [ "    { "
+        , realFloat threshold
+        , ", "
+        , decimal propIdx
+        , ", "
+        , decimal leftNode
+        , ", "
+        , decimal rightNode
+        , " },\n"
+        ]
+
+-- | Renumbers the implementations in the leaves to consecutive indices,
+-- resolving unknown predictions with the misprediction strategy.
+relabelNodes
+    :: Model -> (Int -> Int) -> ([TreeNode], Map (Key Implementation) Int)
+relabelNodes (Model tree) mispredictionStrategy = (reverse nodes, newLabels)
+  where
+    (nodes, newLabels) = VS.foldl' relabel ([], M.empty) tree
 
     relabel
-        :: (Builder, Map (Key Implementation) Int)
+        :: ([TreeNode], Map (Key Implementation) Int)
         -> TreeNode
-        -> (Builder, Map (Key Implementation) Int)
-    relabel (!out, !imap) Node{..}
-      | leftNode /= -1 || rightNode == -1 = (treeRow rightNode, imap)
-      | actualImpl < 0 = (treeRow (-1), imap)
-      | otherwise = (treeRow newVal, newMap)
+        -> ([TreeNode], Map (Key Implementation) Int)
+    relabel (!out, !imap) node@Node{..}
+      | leftNode /= -1 || rightNode == -1 = (node : out, imap)
+      | actualImpl < 0 = (withImpl (-1) : out, imap)
+      | otherwise = (withImpl newVal : out, newMap)
       where
-        treeRow :: Int -> Builder
-        treeRow x = out <> mconcat
-            [ "    { "
-            , realFloat threshold
-            , ", "
-            , decimal propIdx
-            , ", "
-            , decimal leftNode
-            , ", "
-            , decimal x
-            , " },\n"
-            ]
+        withImpl :: Int -> TreeNode
+        withImpl = Node threshold propIdx leftNode
 
         actualImpl :: Int
         actualImpl | rightNode < 0 = mispredictionStrategy rightNode
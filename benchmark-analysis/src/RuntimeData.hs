@@ -148,7 +148,7 @@ getOutputChecker
     :: (MonadIO m, MonadLogger m, MonadMask m, MonadIO n)
     => n (FilePath -> FilePath -> m Bool)
 getOutputChecker = liftIO $ do
-    exePath <- getDataFileName "runtime-data/numdiff.awk"
+    exePath <- getDataFileName "runtime-data/compare-output"
     return $ \file1 file2 -> do
         runProcess exePath ["-q",file1,file2] >>= \case
             ExitSuccess -> return True
@@ -1,11 +1,28 @@
+#include <algorithm>
+#include <cctype>
 #include <fstream>
 
 #include "Algorithm.hpp"
+#include "CPU.hpp"
 #include "CUDA.hpp"
 #include "ImplementationTemplate.hpp"
+#include "ResultWriter.hpp"
 #include "Timer.hpp"
 
 #include "bfs.hpp"
+#include "cpu_kernels.hpp"
+
+template<typename Platform>
+struct Frontier {
+    static void reset() { resetFrontier(); }
+    static unsigned get() { return getFrontier(); }
+};
+
+template<>
+struct Frontier<CPUBackend> {
+    static void reset() { resetCPUFrontier(); }
+    static unsigned get() { return getCPUFrontier(); }
+};
 
 template<typename Platform, typename Vertex, typename Edge, bool switching>
 struct BFS : public ImplementationTemplate<Platform,Vertex,Edge,switching>
@@ -19,6 +36,8 @@ struct BFS : public ImplementationTemplate<Platform,Vertex,Edge,switching>
     using Impl::options;
     using Impl::isSwitching;
 
+    static constexpr bool usesOracle = true;
+
     template<typename T>
     using alloc_t = typename Impl::template alloc_t<T>;
 
@@ -66,6 +85,21 @@ struct BFS : public ImplementationTemplate<Platform,Vertex,Edge,switching>
 
         auto results = backend.template alloc<int>(vertex_count);
 
+        unsigned frontier;
+        std::vector<int> snapshots[2];
+        unsigned snapshotFrontiers[2];
+        auto save = [&](size_t slot) {
+            results.copyDevToHost();
+            snapshots[slot].assign(results.begin(), results.end());
+            snapshotFrontiers[slot] = frontier;
+        };
+        auto restore = [&](size_t slot) {
+            auto& snapshot = snapshots[slot];
+            std::copy(snapshot.begin(), snapshot.end(), results.begin());
+            results.copyHostToDev();
+            frontier = snapshotFrontiers[slot];
+        };
+
         for (size_t i = 0; i < run_count; i++) {
             initResults.start();
             std::fill(results.begin(), results.end(),
@@ -77,7 +111,7 @@ struct BFS : public ImplementationTemplate<Platform,Vertex,Edge,switching>
 
             bfs.start();
 
-            unsigned frontier = 1;
+            frontier = 1;
             int curr = 0;
 
             if constexpr (isSwitching) {
@@ -92,11 +126,35 @@ struct BFS : public ImplementationTemplate<Platform,Vertex,Edge,switching>
 
             do {
                 auto& levelTimer = levelTimers[static_cast<size_t>(curr)];
-                resetFrontier();
-                levelTimer.start();
-                kernel(loader, results, curr++);
-                frontier = getFrontier();
-                levelTimer.stop();
+                bool stepped = false;
+
+                if constexpr (isSwitching) {
+                    if (this->oracle) {
+                        // Only the winning run counts towards the timings,
+                        // its results are kept as this level's results.
+                        bfs.pause();
+                        uint64_t ticks = this->oracleStep(save, restore, [&]() {
+                            setKernelConfig(kernel);
+                            Frontier<Platform>::reset();
+                            kernel(loader, results, curr);
+                            frontier = Frontier<Platform>::get();
+                        });
+                        bfs.resume(ticks);
+                        levelTimer.add(ticks);
+
+                        setKernelConfig(kernel);
+                        curr++;
+                        stepped = true;
+                    }
+                }
+
+                if (!stepped) {
+                    Frontier<Platform>::reset();
+                    levelTimer.start();
+                    kernel(loader, results, curr++);
+                    frontier = Frontier<Platform>::get();
+                    levelTimer.stop();
+                }
 
                 if constexpr (isSwitching) {
                     if (frontier) {
@@ -112,8 +170,176 @@ struct BFS : public ImplementationTemplate<Platform,Vertex,Edge,switching>
             resultTransfer.stop();
         }
 
-        for (size_t i = 0; i < results.size; i++) {
-            outputFile << i << "\t" << results[i] << std::endl;
+        ResultWriter(outputFile, this->binaryOutput)
+            .writeIndexed(results, results.size);
+    }
+};
+
+/* Runs BFS from many roots, a batch of up to 256 roots at a time, with each
+ * root's frontier and visited set packed in a bit lane of per vertex bitsets.
+ * The levels of a batch are stored as 16-bit values per vertex and lane. The
+ * output is the levels of every root in turn, each in the same format as a
+ * single root BFS. Level timers are aggregated over all batches.
+ */
+template<typename Platform, typename Vertex, typename Edge, bool switching>
+struct MultiSourceBFS
+  : public ImplementationTemplate<Platform,Vertex,Edge,switching>
+{
+    using Impl = ImplementationTemplate<Platform,Vertex,Edge,switching>;
+    using Impl::run_count;
+    using Impl::backend;
+    using Impl::loader;
+    using Impl::setKernelConfig;
+    using Impl::vertex_count;
+    using Impl::options;
+
+    template<typename... Args>
+    using Kernel = typename Impl::template GraphKernel<Args...>;
+
+    static constexpr uint16_t unreached = std::numeric_limits<uint16_t>::max();
+
+    std::string rootsArg;
+    size_t lanes;
+
+    using BitKernel =
+        Kernel<uint64_t*,uint64_t*,uint64_t*,uint16_t*,unsigned,int>;
+
+    BitKernel kernel;
+
+    MultiSourceBFS(BitKernel k)
+    : lanes(64), kernel(k)
+    {
+        options.add('R', "roots", "FILE|N", rootsArg,
+                    "File of starting vertices, or the number of evenly "
+                    "spaced starting vertices.")
+               .add('K', "lanes", "NUM", lanes,
+                    "Roots traversed concurrently, a multiple of 64 up to "
+                    "256.");
+    }
+
+    std::vector<unsigned> getRoots()
+    {
+        std::vector<unsigned> roots;
+        if (rootsArg.empty()) {
+            roots.push_back(0);
+        } else if (std::all_of(rootsArg.begin(), rootsArg.end(),
+                       [](unsigned char c) { return std::isdigit(c); })) {
+            size_t count = 0;
+            try {
+                count = std::stoul(rootsArg);
+            } catch (const std::out_of_range&) {
+                reportError("Invalid root count: ", rootsArg);
+            }
+            checkError(count && count <= vertex_count,
+                       "Invalid root count: ", rootsArg);
+
+            for (size_t i = 0; i < count; i++) {
+                size_t root = i * vertex_count / count;
+                roots.push_back(static_cast<unsigned>(root));
+            }
+        } else {
+            std::ifstream input(rootsArg);
+            if (!input) reportError("Failed to open roots file: ", rootsArg);
+
+            for (unsigned root; input >> root;) roots.push_back(root);
+            if (!input.eof()) reportError("Malformed roots file: ", rootsArg);
+        }
+
+        for (auto root : roots) {
+            if (root >= vertex_count) reportError("Invalid root: ", root);
+        }
+        return roots;
+    }
+
+    virtual void runImplementation(std::ofstream& outputFile) override
+    {
+        if (!lanes || lanes % 64 || lanes > 256) {
+            reportError("Lanes should be a multiple of 64, up to 256!");
+        }
+
+        auto roots = getRoots();
+        unsigned words = static_cast<unsigned>(lanes / 64);
+
+        Timer initResults("initResults", run_count);
+        Timer bfs("computation", run_count);
+        std::vector<Timer> levelTimers;
+        levelTimers.reserve(1000);
+
+        std::string timerName = ":bfsLevel";
+        for (int i = 0; i < 1000; i++) {
+            levelTimers.emplace_back(std::to_string(i) + timerName, run_count);
+        }
+
+        Timer resultTransfer("resultTransfer", run_count);
+
+        auto seen = backend.template alloc<uint64_t>(vertex_count * words);
+        auto visit = backend.template alloc<uint64_t>(vertex_count * words);
+        auto next = backend.template alloc<uint64_t>(vertex_count * words);
+        auto levels = backend.template alloc<uint16_t>(vertex_count * lanes);
+        std::vector<int> results(vertex_count);
+
+        ResultWriter writer(outputFile, this->binaryOutput);
+        for (size_t first = 0; first < roots.size(); first += lanes) {
+            size_t batch = std::min(lanes, roots.size() - first);
+
+            for (size_t i = 0; i < run_count; i++) {
+                initResults.start();
+                std::fill(seen.begin(), seen.end(), 0);
+                std::fill(visit.begin(), visit.end(), 0);
+                std::fill(levels.begin(), levels.end(), unreached);
+
+                for (size_t lane = 0; lane < batch; lane++) {
+                    size_t root = roots[first + lane];
+                    size_t word = root * words + lane / 64;
+                    uint64_t bit = uint64_t(1) << (lane % 64);
+
+                    seen[word] |= bit;
+                    visit[word] |= bit;
+                    levels[root * lanes + lane] = 0;
+                }
+
+                seen.copyHostToDev();
+                visit.copyHostToDev();
+                levels.copyHostToDev();
+                initResults.stop();
+
+                bfs.start();
+                setKernelConfig(kernel);
+
+                unsigned frontier;
+                int curr = 0;
+                do {
+                    checkError(static_cast<size_t>(curr) < levelTimers.size(),
+                               "Exceeded ", levelTimers.size(), " BFS levels!");
+
+                    auto& levelTimer = levelTimers[static_cast<size_t>(curr)];
+                    Frontier<Platform>::reset();
+                    levelTimer.start();
+                    if (curr % 2) {
+                        kernel(loader, next, visit, seen, levels, words,
+                               curr++);
+                    } else {
+                        kernel(loader, visit, next, seen, levels, words,
+                               curr++);
+                    }
+                    frontier = Frontier<Platform>::get();
+                    levelTimer.stop();
+                } while (frontier);
+                bfs.stop();
+
+                resultTransfer.start();
+                levels.copyDevToHost();
+                resultTransfer.stop();
+            }
+
+            for (size_t lane = 0; lane < batch; lane++) {
+                for (size_t v = 0; v < vertex_count; v++) {
+                    uint16_t level = levels[v * lanes + lane];
+                    results[v] = level == unreached
+                               ? std::numeric_limits<int>::max() : level;
+                }
+                writer.writeIndexed(results, vertex_count);
+            }
         }
     }
 };
@@ -222,3 +448,82 @@ extern "C" void registerCUDA(Algorithm& result)
 
     result.addImplementation("switch", make_switch_implementation<BFS>(kernelMap));
 }
+
+extern "C" register_algorithm_t registerCPU;
+extern "C" void registerCPU(Algorithm& result)
+{
+    INITIALISE_ALGORITHM(result);
+    KernelBuilder<CPUBackend,unsigned,unsigned> make_kernel;
+
+    KernelMap kernelMap
+    { std::pair
+        { "edge-list"
+        , std::tuple
+            { make_kernel
+                ( cpuEdgeListBfs
+                , work_division::edge
+                , tag_t(Rep::EdgeList)
+                )
+            }
+        }
+    };
+
+    kernelMap["rev-edge-list"] = {
+        make_kernel
+            ( cpuRevEdgeListBfs
+            , work_division::edge
+            , tag_t(Rep::EdgeList)
+            , tag_t(Dir::Reverse)
+            )
+    };
+
+    kernelMap["struct-edge-list"] = {
+        make_kernel
+            ( cpuStructEdgeListBfs
+            , work_division::edge
+            , tag_t(Rep::StructEdgeList)
+            )
+    };
+
+    kernelMap["rev-struct-edge-list"] = {
+        make_kernel
+            ( cpuRevStructEdgeListBfs
+            , work_division::edge
+            , tag_t(Rep::StructEdgeList)
+            , tag_t(Dir::Reverse)
+            )
+    };
+
+    kernelMap["vertex-push"] = {
+        make_kernel
+            ( cpuVertexPushBfs
+            , work_division::vertex
+            , tag_t(Rep::CSR)
+            )
+    };
+
+    kernelMap["vertex-pull"] = {
+        make_kernel
+            ( cpuVertexPullBfs
+            , work_division::vertex
+            , tag_t(Rep::CSR)
+            , tag_t(Dir::Reverse)
+            )
+    };
+
+    for (auto& [name, kernel] : kernelMap) {
+        result.addImplementation(name, make_implementation<BFS>(kernel));
+    }
+
+    result.addImplementation("switch", make_switch_implementation<BFS>(kernelMap));
+
+    result.addImplementation("multi-source",
+        make_implementation<MultiSourceBFS>(std::tuple
+            { make_kernel
+                ( cpuMultiSourceBfs
+                , work_division::vertex
+                , tag_t(Rep::CSR)
+                , tag_t(Dir::Reverse)
+                )
+            }));
+}
@@ -0,0 +1,181 @@
+#include "CPU.hpp"
+#include "cpu_kernels.hpp"
+
+static unsigned frontier = 0;
+
+void resetCPUFrontier()
+{ __atomic_store_n(&frontier, 0U, __ATOMIC_RELAXED); }
+
+unsigned getCPUFrontier()
+{ return __atomic_load_n(&frontier, __ATOMIC_RELAXED); }
+
+static inline bool
+visit(int *levels, unsigned vertex, int newDepth)
+{
+    if (CPUBackend::atomicLoad(&levels[vertex]) <= newDepth) return false;
+    return CPUBackend::atomicMin(&levels[vertex], newDepth) > newDepth;
+}
+
+void
+cpuEdgeListBfs(EdgeList<unsigned> *graph, int *levels, int depth)
+{
+    auto [start, end] = CPUBackend::blockRange(graph->edge_count);
+    unsigned count = 0;
+    int newDepth = depth + 1;
+
+    for (uint64_t idx = start; idx < end; idx++) {
+        if (CPUBackend::atomicLoad(&levels[graph->inEdges[idx]]) == depth) {
+            if (visit(levels, graph->outEdges[idx], newDepth)) count++;
+        }
+    }
+
+    CPUBackend::atomicAdd(&frontier, count);
+}
+
+void
+cpuRevEdgeListBfs(EdgeList<unsigned> *graph, int *levels, int depth)
+{
+    auto [start, end] = CPUBackend::blockRange(graph->edge_count);
+    unsigned count = 0;
+    int newDepth = depth + 1;
+
+    for (uint64_t idx = start; idx < end; idx++) {
+        if (CPUBackend::atomicLoad(&levels[graph->outEdges[idx]]) == depth) {
+            if (visit(levels, graph->inEdges[idx], newDepth)) count++;
+        }
+    }
+
+    CPUBackend::atomicAdd(&frontier, count);
+}
+
+void
+cpuStructEdgeListBfs(StructEdgeList<unsigned> *graph, int *levels, int depth)
+{
+    auto [start, end] = CPUBackend::blockRange(graph->edge_count);
+    unsigned count = 0;
+    int newDepth = depth + 1;
+
+    for (uint64_t idx = start; idx < end; idx++) {
+        edge<unsigned> myEdge = graph->edges[idx];
+        if (CPUBackend::atomicLoad(&levels[myEdge.in]) == depth) {
+            if (visit(levels, myEdge.out, newDepth)) count++;
+        }
+    }
+
+    CPUBackend::atomicAdd(&frontier, count);
+}
+
+void
+cpuRevStructEdgeListBfs
+(StructEdgeList<unsigned> *graph, int *levels, int depth)
+{
+    auto [start, end] = CPUBackend::blockRange(graph->edge_count);
+    unsigned count = 0;
+    int newDepth = depth + 1;
+
+    for (uint64_t idx = start; idx < end; idx++) {
+        edge<unsigned> myEdge = graph->edges[idx];
+        if (CPUBackend::atomicLoad(&levels[myEdge.out]) == depth) {
+            if (visit(levels, myEdge.in, newDepth)) count++;
+        }
+    }
+
+    CPUBackend::atomicAdd(&frontier, count);
+}
+
+void
+cpuVertexPushBfs(CSR<unsigned,unsigned> *graph, int *levels, int depth)
+{
+    auto [start, end] = CPUBackend::blockRange(graph->vertex_count);
+    unsigned *vertices = graph->vertices;
+    unsigned *edges = graph->edges;
+    unsigned count = 0;
+    int newDepth = depth + 1;
+
+    for (uint64_t idx = start; idx < end; idx++) {
+        if (CPUBackend::atomicLoad(&levels[idx]) == depth) {
+            for (unsigned i = vertices[idx]; i < vertices[idx + 1]; i++) {
+                if (visit(levels, edges[i], newDepth)) count++;
+            }
+        }
+    }
+
+    CPUBackend::atomicAdd(&frontier, count);
+}
+
+void
+cpuVertexPullBfs(CSR<unsigned,unsigned> *graph, int *levels, int depth)
+{
+    auto [start, end] = CPUBackend::blockRange(graph->vertex_count);
+    unsigned *rev_vertices = graph->vertices;
+    unsigned *rev_edges = graph->edges;
+    unsigned count = 0;
+    int newDepth = depth + 1;
+
+    for (uint64_t idx = start; idx < end; idx++) {
+        if (levels[idx] > newDepth) {
+            for (unsigned i = rev_vertices[idx]; i < rev_vertices[idx + 1]; i++) {
+                if (CPUBackend::atomicLoad(&levels[rev_edges[i]]) == depth) {
+                    __atomic_store_n(&levels[idx], newDepth, __ATOMIC_RELAXED);
+                    count++;
+                    break;
+                }
+            }
+        }
+    }
+
+    CPUBackend::atomicAdd(&frontier, count);
+}
+
+/* Bit-parallel BFS from up to 64 * words (at most 256) sources at once,
+ * source i being bit i % 64 of word i / 64 of a vertex' bitsets. Pulls the
+ * visit bits of each vertex' in-neighbours, so every vertex' next, seen, and
+ * level entries are only written by the thread owning it. Levels are stored
+ * per vertex, i.e. levels[vertex * 64 * words + source].
+ */
+void
+cpuMultiSourceBfs
+( CSR<unsigned,unsigned> *graph
+, uint64_t *visit
+, uint64_t *next
+, uint64_t *seen
+, uint16_t *levels
+, unsigned words
+, int depth
+)
+{
+    auto [start, end] = CPUBackend::blockRange(graph->vertex_count);
+    unsigned *rev_vertices = graph->vertices;
+    unsigned *rev_edges = graph->edges;
+    unsigned count = 0;
+    uint16_t newDepth = static_cast<uint16_t>(depth + 1);
+
+    uint64_t bits[4];
+    for (uint64_t idx = start; idx < end; idx++) {
+        for (unsigned w = 0; w < words; w++) bits[w] = 0;
+
+        for (unsigned i = rev_vertices[idx]; i < rev_vertices[idx + 1]; i++) {
+            const uint64_t *neighbour = visit + uint64_t(rev_edges[i]) * words;
+            for (unsigned w = 0; w < words; w++) bits[w] |= neighbour[w];
+        }
+
+        bool reached = false;
+        uint16_t *vertexLevels = levels + idx * 64 * words;
+        for (unsigned w = 0; w < words; w++) {
+            uint64_t newBits = bits[w] & ~seen[idx * words + w];
+            next[idx * words + w] = newBits;
+            if (!newBits) continue;
+
+            reached = true;
+            seen[idx * words + w] |= newBits;
+            for (; newBits; newBits &= newBits - 1) {
+                unsigned source = w * 64 + unsigned(__builtin_ctzll(newBits));
+                vertexLevels[source] = newDepth;
+            }
+        }
+
+        if (reached) count++;
+    }
+
+    CPUBackend::atomicAdd(&frontier, count);
+}
@@ -0,0 +1,40 @@
+#ifndef BFS_CPU_KERNELS_HPP
+#define BFS_CPU_KERNELS_HPP
+
+#include <cstdint>
+
+#include "GraphRep.hpp"
+
+void resetCPUFrontier();
+unsigned getCPUFrontier();
+
+void
+cpuEdgeListBfs(EdgeList<unsigned> *graph, int *levels, int depth);
+
+void
+cpuRevEdgeListBfs(EdgeList<unsigned> *graph, int *levels, int depth);
+
+void
+cpuStructEdgeListBfs(StructEdgeList<unsigned> *graph, int *levels, int depth);
+
+void
+cpuRevStructEdgeListBfs
+(StructEdgeList<unsigned> *graph, int *levels, int depth);
+
+void
+cpuVertexPushBfs(CSR<unsigned,unsigned> *graph, int *levels, int depth);
+
+void
+cpuVertexPullBfs(CSR<unsigned,unsigned> *graph, int *levels, int depth);
+
+void
+cpuMultiSourceBfs
+( CSR<unsigned,unsigned> *graph
+, uint64_t *visit
+, uint64_t *next
+, uint64_t *seen
+, uint16_t *levels
+, unsigned words
+, int depth
+);
+#endif
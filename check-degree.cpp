@@ -2,40 +2,57 @@
 
 #include <cstring>
 #include <iostream>
-#include <map>
+#include <vector>
 
 #include "utils/Graph.hpp"
 
 using namespace std;
 
-enum sort_order {
-    in_degree,
-    out_degree,
-    abs_degree
-};
-
 static const char *execName = "check-degree";
 
+template<typename V, typename E>
+static void
+reportDegrees
+( Graph<V,E>& graph, const string& name, Degrees ordering, bool verbose
+, const string& degreeCache)
+{
+    auto props = graph.degreeProperties(degreeCache);
+
+    cout << name << ": " << endl;
+    cout << "Vertex count: " << graph.vertex_count << endl;
+    cout << "Edge count: " << graph.edge_count << endl;
+    if (verbose) {
+        cout << "Degrees: " << endl;
+        for (auto& p : props.histogram(ordering)) {
+            cout << "\t" << p.first << " : " << p.second << endl;
+        }
+    }
+    cout << endl;
+}
+
 static void __attribute__((noreturn))
 usage(int exitCode = EXIT_FAILURE)
 {
     ostream& out(exitCode == EXIT_SUCCESS ? cout : cerr);
     out << "Usage:" << endl;
     out << execName << " [--help | -h]" << endl;
-    out << execName << " [-v | --verbose] abs <graph1> [<graph2>...]" << endl;
-    out << execName << " [-v | --verbose] in <graph1> [<graph2>...]" << endl;
-    out << execName << " [-v | --verbose] out <graph1> [<graph2>...]" << endl;
+    for (auto ordering : { "abs", "in", "out" }) {
+        out << execName << " [-v | --verbose] [-G DIR | --degree-cache DIR] "
+            << ordering << " <graph1> [<graph2>...]" << endl;
+    }
     exit(exitCode);
 }
 
 int main(int argc, char **argv)
 {
     string name;
-    sort_order ordering;
+    Degrees ordering;
     int verbose = false;
-    const char *optString = ":vh?";
+    string degreeCache;
+    const char *optString = ":vG:h?";
     static const struct option longopts[] = {
         { "verbose", no_argument, &verbose, 1},
+        { "degree-cache", required_argument, nullptr, 'G' },
         { "help", no_argument, nullptr, 'h' },
         { nullptr, 0, nullptr, 0 },
     };
@@ -55,6 +72,10 @@ int main(int argc, char **argv)
                 verbose = true;
                 break;
 
+            case 'G':
+                degreeCache = optarg;
+                break;
+
             case 'h':
             case '?':
                 usage(EXIT_SUCCESS);
@@ -74,41 +95,17 @@ int main(int argc, char **argv)
 
     if (argc <= 1) usage();
 
-    if (!strcmp(argv[0], "abs")) ordering = abs_degree;
-    else if (!strcmp(argv[0], "in")) ordering = in_degree;
-    else if (!strcmp(argv[0], "out")) ordering = out_degree;
+    if (!strcmp(argv[0], "abs")) ordering = Degrees::abs;
+    else if (!strcmp(argv[0], "in")) ordering = Degrees::in;
+    else if (!strcmp(argv[0], "out")) ordering = Degrees::out;
     else usage();
 
     for (int i = 1; i < argc; i++) {
         name = string(argv[i]);
 
-        Graph<uint64_t, uint64_t> graph(name);
-        map<size_t, size_t> degrees;
-
-        for (auto v : graph.vertices) {
-            size_t degree = 0;
-
-            if (ordering == out_degree || ordering == abs_degree) {
-                degree += v.edges.size;
-            }
-
-            if (ordering == in_degree || (ordering == abs_degree && !graph.undirected)) {
-                degree += v.rev_edges.size;
-            }
-
-            degrees[degree]++;
-        }
-
-        cout << name << ": " << endl;
-        cout << "Vertex count: " << graph.vertex_count << endl;
-        cout << "Edge count: " << graph.edge_count << endl;
-        if (verbose) {
-            cout << "Degrees: " << endl;
-            for (auto &pair : degrees) {
-                cout << "\t" << pair.first << " : " << pair.second << endl;
-            }
-        }
-        cout << endl;
+        dispatch_graph(name, [&](auto& graph) {
+            reportDegrees(graph, name, ordering, verbose, degreeCache);
+        });
     }
 
     return 0;
@@ -0,0 +1,376 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+#include "options/Options.hpp"
+#include "utils/Graph.hpp"
+#include "utils/Util.hpp"
+
+using namespace std;
+
+static const char *exeName = "compare-output";
+static Options options('h', "help", cout, [](ostream& out)
+{
+    out << "Usage:" << endl;
+    out << "    " << exeName << " file1 file2 [file3...]" << endl << endl;
+    out << "Compares the result columns (all but the first) of every file "
+        << "against file1." << endl << endl;
+    out << "Options:" << endl;
+});
+
+class MappedFile {
+    int fd;
+
+  public:
+    const char *data;
+    size_t size;
+
+    MappedFile(const string& fileName) : fd(-1), data(nullptr), size(0)
+    {
+        fd = open(fileName.c_str(), O_RDONLY);
+        if (fd == -1) {
+            perror("open");
+            reportError("Failed to open: ", fileName);
+        }
+
+        struct stat statbuf;
+        if (fstat(fd, &statbuf) != 0) {
+            perror("fstat");
+            reportError("Failed to stat: ", fileName);
+        }
+        size = static_cast<size_t>(statbuf.st_size);
+        if (!size) return;
+
+        void *ptr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (ptr == MAP_FAILED) {
+            perror("mmap");
+            reportError("Failed to mmap: ", fileName);
+        }
+        madvise(ptr, size, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(ptr);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    void operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other)
+      : fd(other.fd), data(other.data), size(other.size)
+    {
+        other.fd = -1;
+        other.data = nullptr;
+    }
+
+    ~MappedFile()
+    {
+        if (data) munmap(const_cast<char*>(data), size);
+        if (fd != -1) close(fd);
+    }
+};
+
+// Byte offsets of line starts, found by counting newlines in fixed size
+// blocks in parallel, so a line's start can be found without scanning the
+// entire file.
+class LineIndex {
+    static constexpr size_t blockSize = 1 << 20;
+
+    const MappedFile& file;
+    vector<uint64_t> newlines;
+
+  public:
+    uint64_t lineCount;
+
+    LineIndex(const MappedFile& f) : file(f)
+    {
+        size_t blocks = (file.size + blockSize - 1) / blockSize;
+        newlines.assign(blocks + 1, 0);
+
+        parallel_blocks(blocks, [&](uint64_t b) {
+            auto begin = file.data + b * blockSize;
+            auto end = file.data + min(file.size, (b + 1) * blockSize);
+            newlines[b + 1] = static_cast<uint64_t>(std::count(begin, end, '\n'));
+        });
+
+        for (size_t b = 0; b < blocks; b++) newlines[b + 1] += newlines[b];
+
+        lineCount = newlines.back();
+        if (file.size && file.data[file.size - 1] != '\n') lineCount++;
+    }
+
+    size_t blocks() const
+    { return newlines.size() - 1; }
+
+    // Index of the first line starting in block b.
+    uint64_t firstLine(size_t b) const
+    {
+        if (b == 0) return 0;
+        if (b >= blocks()) return lineCount;
+        return newlines[b] + (file.data[b * blockSize - 1] == '\n' ? 0 : 1);
+    }
+
+    size_t offset(uint64_t line) const
+    {
+        if (line == 0) return 0;
+        if (line > newlines.back()) return file.size;
+
+        // Block containing the newline ending the previous line.
+        auto it = lower_bound(newlines.begin() + 1, newlines.end(), line);
+        size_t b = static_cast<size_t>(it - newlines.begin()) - 1;
+        uint64_t remaining = line - newlines[b];
+
+        const char *ptr = file.data + b * blockSize;
+        for (;; ptr++) {
+            if (*ptr == '\n' && --remaining == 0) break;
+        }
+        return static_cast<size_t>(ptr - file.data) + 1;
+    }
+};
+
+struct Field {
+    enum { integer, real, text } type;
+    int64_t intVal;
+    double realVal;
+    string_view str;
+
+    Field(string_view s) : type(text), intVal(0), realVal(0), str(s)
+    {
+        auto first = s.data(), last = s.data() + s.size();
+        if (*first == '+') first++;
+
+        auto result = from_chars(first, last, intVal);
+        if (result.ec == errc() && result.ptr == last) {
+            type = integer;
+            realVal = static_cast<double>(intVal);
+            return;
+        }
+
+        // from_chars for floating point is missing from older libc++, and
+        // strtod needs a NUL-terminated copy.
+        char buf[64];
+        size_t len = static_cast<size_t>(last - first);
+        if (len == 0 || len >= sizeof buf) return;
+
+        memcpy(buf, first, len);
+        buf[len] = '\0';
+
+        char *end;
+        realVal = strtod(buf, &end);
+        if (end == buf + len) type = real;
+        else realVal = 0;
+    }
+};
+
+struct Mismatch {
+    uint64_t line;
+    size_t field;
+    size_t file;
+    string_view expected, actual;
+    double diff;
+};
+
+struct ChunkResult {
+    uint64_t count = 0;
+    double maxDiff = 0;
+    vector<Mismatch> mismatches;
+};
+
+static void
+fields(string_view line, vector<string_view>& result)
+{
+    result.clear();
+    size_t i = 0;
+    while (true) {
+        while (i < line.size() && isspace(static_cast<unsigned char>(line[i]))) i++;
+        if (i == line.size()) break;
+
+        size_t start = i;
+        while (i < line.size() && !isspace(static_cast<unsigned char>(line[i]))) i++;
+        result.push_back(line.substr(start, i - start));
+    }
+}
+
+static string_view
+getLine(const MappedFile& file, size_t& pos)
+{
+    if (pos >= file.size) return string_view();
+
+    auto start = file.data + pos;
+    auto end = static_cast<const char*>(memchr(start, '\n', file.size - pos));
+    if (!end) end = file.data + file.size;
+
+    pos = static_cast<size_t>(end - file.data) + 1;
+    return string_view(start, static_cast<size_t>(end - start));
+}
+
+int main(int argc, char * const *argv)
+{
+    double precision = 0.0;
+    double relative = 0.0;
+    int verbosity = 1;
+    size_t maxReported = 0;
+
+    options.add('p', "precision", "PREC", precision,
+                "Size of floating point error to ignore.")
+           .add('r', "relative", "REL", relative,
+                "Relative floating point error to ignore.")
+           .add('q', "quiet", verbosity, 0,
+                "Only report the error count, as exit code.")
+           .add('v', "verbose", verbosity, 2,
+                "Print individual errors exceeding threshold.")
+           .add('n', "max-errors", "NUM", maxReported,
+                "Only print the first NUM errors, 0 prints all.");
+
+    std::set_new_handler(out_of_memory);
+
+    auto files = options.parseArgs(argc, argv);
+    if (files.size() < 2) {
+        options.usage(cerr);
+        return EXIT_FAILURE;
+    }
+
+    vector<MappedFile> mapped;
+    for (auto& file : files) mapped.emplace_back(file);
+
+    vector<LineIndex> indices;
+    for (auto& file : mapped) indices.emplace_back(file);
+
+    uint64_t lineCount = 0;
+    for (auto& index : indices) lineCount = max(lineCount, index.lineCount);
+
+    // Chunks start at lines that start in a block of the first file (or of
+    // the longest file, once the first file runs out).
+    size_t longest = 0;
+    for (size_t i = 0; i < indices.size(); i++) {
+        if (indices[i].lineCount > indices[longest].lineCount) longest = i;
+    }
+
+    vector<uint64_t> chunkStarts;
+    for (auto idx : { size_t(0), longest }) {
+        for (size_t b = 0; b < indices[idx].blocks(); b++) {
+            chunkStarts.push_back(indices[idx].firstLine(b));
+        }
+    }
+    chunkStarts.push_back(lineCount);
+    sort(chunkStarts.begin(), chunkStarts.end());
+    chunkStarts.erase(unique(chunkStarts.begin(), chunkStarts.end()),
+                      chunkStarts.end());
+
+    size_t chunks = chunkStarts.size() - 1;
+    vector<ChunkResult> results(chunks);
+
+    bool reportAll = maxReported == 0;
+    auto compare = [&](const Field& expected, const Field& actual, double& diff)
+    {
+        if (expected.type == Field::integer && actual.type == Field::integer) {
+            diff = abs(static_cast<double>(actual.intVal)
+                     - static_cast<double>(expected.intVal));
+            return expected.intVal != actual.intVal;
+        }
+
+        if (expected.type == Field::text || actual.type == Field::text) {
+            diff = NAN;
+            return expected.str != actual.str;
+        }
+
+        if (isnan(expected.realVal) || isnan(actual.realVal)) {
+            diff = NAN;
+            return isnan(expected.realVal) != isnan(actual.realVal);
+        }
+
+        if (expected.realVal == actual.realVal) {
+            diff = 0;
+            return false;
+        }
+
+        diff = abs(expected.realVal - actual.realVal);
+        double scale = max(abs(expected.realVal), abs(actual.realVal));
+        return diff > precision && !(diff <= relative * scale);
+    };
+
+    parallel_blocks(chunks, [&](uint64_t c) {
+        auto& result = results[c];
+        uint64_t firstLine = chunkStarts[c], endLine = chunkStarts[c + 1];
+
+        vector<size_t> positions;
+        for (auto& index : indices) positions.push_back(index.offset(firstLine));
+
+        vector<vector<string_view>> lines(mapped.size());
+        auto report = [&](uint64_t line, size_t field, size_t file,
+                          string_view e, string_view a, double diff)
+        {
+            result.count++;
+            if (!isnan(diff)) result.maxDiff = max(result.maxDiff, diff);
+            if (verbosity == 2 && (reportAll || result.mismatches.size() < maxReported)) {
+                result.mismatches.push_back({line, field, file, e, a, diff});
+            }
+        };
+
+        for (uint64_t line = firstLine; line < endLine; line++) {
+            size_t n = 0;
+            for (size_t f = 0; f < mapped.size(); f++) {
+                fields(getLine(mapped[f], positions[f]), lines[f]);
+                n = max(n, lines[f].size());
+            }
+
+            auto& expected = lines[0];
+            for (size_t i = 1; i < n; i++) {
+                for (size_t f = 1; f < mapped.size(); f++) {
+                    auto& actual = lines[f];
+                    if (i >= expected.size() || i >= actual.size()) {
+                        report(line, i, f, i < expected.size() ? expected[i] : "",
+                               i < actual.size() ? actual[i] : "", NAN);
+                        continue;
+                    }
+
+                    double diff;
+                    if (compare(Field(expected[i]), Field(actual[i]), diff)) {
+                        report(line, i, f, expected[i], actual[i], diff);
+                    }
+                }
+            }
+        }
+    });
+
+    uint64_t count = 0;
+    double maxDiff = 0;
+    size_t printed = 0;
+    for (auto& result : results) {
+        count += result.count;
+        maxDiff = max(maxDiff, result.maxDiff);
+
+        for (auto& m : result.mismatches) {
+            if (!reportAll && printed++ >= maxReported) break;
+
+            cout << "Line " << m.line + 1 << " field " << m.field + 1;
+            if (mapped.size() > 2) {
+                cout << " (" << files[0] << " and " << files[m.file] << ")";
+            }
+            cout << ":" << endl;
+            cout << m.expected << " " << m.actual << " (difference: ";
+            if (isnan(m.diff)) cout << "n/a";
+            else cout << m.diff;
+            cout << ")" << endl << endl;
+        }
+    }
+
+    if (verbosity == 2) cout << endl;
+    if (verbosity) {
+        if (count > 0) {
+            cout << "Error count: " << count << "\tMax diff: " << maxDiff << endl;
+        } else {
+            cout << "No differences!" << endl;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    return static_cast<int>(min<uint64_t>(count, 255));
+}
@@ -0,0 +1,30 @@
+#include <iostream>
+
+#include "PropertyLog.hpp"
+#include "options/Options.hpp"
+#include "utils/Util.hpp"
+
+using namespace std;
+
+static const char *exeName = "convert-property-log";
+static Options options('h', "help", cout, [](ostream& out)
+{
+    out << "Usage:" << endl;
+    out << "    " << exeName << " binary-log text-log" << endl << endl;
+    out << "Converts a property log written with kernel-runner's "
+        << "--binary-log to the text format." << endl << endl;
+    out << "Options:" << endl;
+});
+
+int main(int argc, char * const *argv)
+{
+    std::set_new_handler(out_of_memory);
+    auto files = options.parseArgs(argc, argv);
+    if (files.size() != 2) {
+        options.usage(cerr);
+        return EXIT_FAILURE;
+    }
+
+    PropertyLog::toText(files[0], files[1]);
+    return 0;
+}
@@ -150,6 +150,8 @@ template<bool undirected>
 class Crossover {
     Graph_t graph1;
     Graph_t graph2;
+    // Merged with the edges of both graphs in forward and reverse order, so
+    // unlike gen-graph's random edges these are kept in memory.
     const vector<edge> mutations;
     const vector<edge> rev_mutations;
 
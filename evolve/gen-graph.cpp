@@ -1,4 +1,5 @@
 #include <getopt.h>
+#include <unistd.h>
 
 #include <algorithm>
 #include <cmath>
@@ -9,17 +10,18 @@
 #include <vector>
 
 #include "utils/Graph.hpp"
+#include "utils/GraphBuilder.hpp"
 
 using namespace std;
 
-typedef Graph<uint64_t,uint64_t> Graph_t;
+typedef GraphBuilder<uint64_t,uint64_t> Builder;
 
-string gen_chain(vector<Edge<uint64_t>>&, bool undirected, size_t);
-string gen_star(vector<Edge<uint64_t>>&, bool undirected, size_t);
-string gen_mesh(vector<Edge<uint64_t>>&, bool undirected, size_t, size_t);
-string gen_degree4(vector<Edge<uint64_t>>&, bool undirected, size_t);
-string gen_degree6(vector<Edge<uint64_t>>&, bool undirected, size_t);
-string gen_anydegree(vector<Edge<uint64_t>>&, bool undirected, size_t, size_t);
+string gen_chain(Builder&, bool undirected, size_t);
+string gen_star(Builder&, bool undirected, size_t);
+string gen_mesh(Builder&, bool undirected, size_t, size_t);
+string gen_degree4(Builder&, bool undirected, size_t);
+string gen_degree6(Builder&, bool undirected, size_t);
+string gen_anydegree(Builder&, bool undirected, size_t, size_t);
 
 string gen_name(ostringstream&);
 
@@ -65,15 +67,13 @@ usage(int exitCode = EXIT_FAILURE)
     out << execName << " [--help | -h ]" << endl;
     for (auto&& arg : args) {
         out << execName << " [--directed | -d ] [--undirected | -u] "
-             << arg << endl;
+             << "[--memory MB | -m MB] " << arg << endl;
     }
     exit(exitCode);
 }
 
-string gen_chain(vector<Edge<uint64_t>>& edges, bool undirected, size_t N)
+string gen_chain(Builder& edges, bool undirected, size_t N)
 {
-    edges.reserve(undirected ? 2*N : N);
-
     for (uint64_t i = 0; i < N; i++) {
         edges.emplace_back(i, i+1);
         if (undirected) edges.emplace_back(i+1, i);
@@ -82,10 +82,8 @@ string gen_chain(vector<Edge<uint64_t>>& edges, bool undirected, size_t N)
     return file_name("chain", N);
 }
 
-string gen_star(vector<Edge<uint64_t>>& edges, bool undirected, size_t N)
+string gen_star(Builder& edges, bool undirected, size_t N)
 {
-    edges.reserve(undirected ? 2*N : N);
-
     for (size_t i = 0; i < N; i++) {
         edges.emplace_back(0, i+1);
         if (undirected) edges.emplace_back(i+1, 0);
@@ -94,28 +92,18 @@ string gen_star(vector<Edge<uint64_t>>& edges, bool undirected, size_t N)
     return file_name("star", N);
 }
 
-string gen_mesh(vector<Edge<uint64_t>>& edges, bool undirected, size_t H, size_t W)
+string gen_mesh(Builder& edges, bool undirected, size_t H, size_t W)
 {
-    size_t increment = undirected ? 2 : 1;
-    size_t edge_count = 0;
-
-    for (size_t n = 0; n < 2; n++) {
-        edges.reserve(edge_count);
-        for (size_t j = 0; j < H; j++) {
-            for (size_t i = 0; i < W; i++) {
-                if (i < W-1) {
-                    if (n) {
-                        edges.emplace_back(j*W+i, j*W+i+1);
-                        if (undirected) edges.emplace_back(j*W+i+1, j*W+i);
-                    } else edge_count += increment;
-                }
+    for (size_t j = 0; j < H; j++) {
+        for (size_t i = 0; i < W; i++) {
+            if (i < W-1) {
+                edges.emplace_back(j*W+i, j*W+i+1);
+                if (undirected) edges.emplace_back(j*W+i+1, j*W+i);
+            }
 
-                if (j < H-1) {
-                    if (n) {
-                        edges.emplace_back(j*W+i, (j+1)*W+i);
-                        if (undirected) edges.emplace_back((j+1)*W+i, j*W+i);
-                    } else edge_count += increment;
-                }
+            if (j < H-1) {
+                edges.emplace_back(j*W+i, (j+1)*W+i);
+                if (undirected) edges.emplace_back((j+1)*W+i, j*W+i);
             }
         }
     }
@@ -123,10 +111,8 @@ string gen_mesh(vector<Edge<uint64_t>>& edges, bool undirected, size_t H, size_t
     return file_name("mesh", H, W);
 }
 
-string gen_degree4(vector<Edge<uint64_t>>& edges, bool undirected, size_t N)
+string gen_degree4(Builder& edges, bool undirected, size_t N)
 {
-    edges.reserve((undirected ? 4 : 2) * N * N);
-
     for (size_t j = 0; j < N; j++) {
         for (size_t i = 0; i < N; i++) {
             if (i < N-1) {
@@ -151,10 +137,8 @@ string gen_degree4(vector<Edge<uint64_t>>& edges, bool undirected, size_t N)
     return tmp;
 }
 
-string gen_degree6(vector<Edge<uint64_t>>& edges, bool undirected, size_t N)
+string gen_degree6(Builder& edges, bool undirected, size_t N)
 {
-    edges.reserve((undirected ? 6 : 3) * N * N * N);
-
     for (size_t k = 0; k < N; k++) {
         for (size_t j = 0; j < N; j++) {
             for (size_t i = 0; i < N; i++) {
@@ -188,7 +172,7 @@ string gen_degree6(vector<Edge<uint64_t>>& edges, bool undirected, size_t N)
     return file_name("degree6", N);
 }
 
-string gen_anydegree(vector<Edge<uint64_t>>& edges, bool undirected, size_t N, size_t D)
+string gen_anydegree(Builder& edges, bool undirected, size_t N, size_t D)
 {
     std::vector<uint64_t> powA(D + 1);
     std::vector<uint64_t> coef(D);
@@ -197,8 +181,6 @@ string gen_anydegree(vector<Edge<uint64_t>>& edges, bool undirected, size_t N, s
         powA[p] = static_cast<uint64_t>(pow(N,p));
     }
 
-    edges.reserve((undirected ? 2 : 1) *D * static_cast<uint64_t>(pow(N, D)));
-
     for (uint64_t i = 0; i < static_cast<uint64_t>(pow(N, D)); i++) {
         uint64_t tmp = i;
 
@@ -210,8 +192,10 @@ string gen_anydegree(vector<Edge<uint64_t>>& edges, bool undirected, size_t N, s
         for (uint64_t p = 0; p < D; p++) {
             if (coef[p] < N-1) {
                 edges.emplace_back(i, i + powA[p]);
+                if (undirected) edges.emplace_back(i + powA[p], i);
             } else {
                 edges.emplace_back((i + powA[p]) - powA[p+1], i);
+                if (undirected) edges.emplace_back(i, (i + powA[p]) - powA[p+1]);
             }
         }
     }
@@ -223,14 +207,14 @@ int main(int argc, char **argv)
 {
     string name;
     int undirected = false;
-    bool sorted = false;
     uint64_t vertex_count = 0;
-    vector<Edge<uint64_t>> edges;
+    size_t memoryBudget = 4096;
 
-    const char *optString = ":duh?";
+    const char *optString = ":dm:uh?";
     static const struct option longopts[] = {
         { "directed", no_argument, &undirected, false},
         { "undirected", no_argument, &undirected, true},
+        { "memory", required_argument, nullptr, 'm' },
         { "help", no_argument, nullptr, 'h' },
         { nullptr, 0, nullptr, 0 },
     };
@@ -253,6 +237,10 @@ int main(int argc, char **argv)
                 undirected = true;
                 break;
 
+            case 'm':
+                memoryBudget = stoul(optarg);
+                break;
+
             case 'h':
             case '?':
                 usage(EXIT_SUCCESS);
@@ -270,6 +258,9 @@ int main(int argc, char **argv)
     argc -= optind;
     argv = &argv[optind];
 
+    string spillPrefix = string(execName) + "." + to_string(getpid());
+    Builder edges(spillPrefix, undirected, memoryBudget * 1024 * 1024, false);
+
     if (argc == 2 && !strcmp(argv[0], "chain")) {
         vertex_count = stoull(argv[1]);
         name = gen_chain(edges, undirected, vertex_count);
@@ -287,32 +278,26 @@ int main(int argc, char **argv)
     } else if (argc == 3 && !strcmp(argv[0], "any")) {
         name = gen_anydegree(edges, undirected, stoull(argv[1]), stoull(argv[2]));
     } else if (argc == 4 && !strcmp(argv[0], "random")) {
-        sorted = true;
         name = argv[1];
         vertex_count = stoul(argv[2]);
         uint64_t edge_count = stoul(argv[3]);
-        edges = random_edges<uint64_t>(undirected, vertex_count, edge_count);
+        RandomEdges<uint64_t>(undirected, vertex_count).sample(edge_count,
+            [&](uint64_t, vector<Edge<uint64_t>>&& block) {
+                edges.addEdges(move(block));
+            });
     } else if (argc == 4 && !strcmp(argv[0], "random-mutations")) {
-        sorted = true;
         name = argv[1];
         vertex_count = stoul(argv[2]);
         double mutation_rate = stod(argv[3]);
-        edges = random_edges<uint64_t>(undirected, vertex_count, mutation_rate);
+        RandomEdges<uint64_t>(undirected, vertex_count).sample(mutation_rate,
+            [&](uint64_t, vector<Edge<uint64_t>>&& block) {
+                edges.addEdges(move(block));
+            });
     } else {
         usage();
     }
 
-    if (undirected) {
-        if (sorted) Graph_t::outputSortedUniq(name, vertex_count, edges);
-        else Graph_t::outputUniq(name, vertex_count, edges);
-    } else {
-        auto rev_edges = reverse_and_sort(edges);
-        if (sorted) {
-            Graph_t::outputSortedUniq(name, vertex_count, edges, rev_edges);
-        } else {
-            Graph_t::outputUniq(name, vertex_count, edges, rev_edges);
-        }
-    }
+    edges.write(name, vertex_count);
 
     cout << name << endl;
 
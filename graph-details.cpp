@@ -23,9 +23,12 @@ int main(int argc, char * const *argv)
 {
     map<string, Degrees> orderings;
     bool verbose = false;
+    string degreeCache;
     vector<string> graphs;
 
-    options.add('v', "verbose", verbose, true, "Verbose output.");
+    options.add('v', "verbose", verbose, true, "Verbose output.")
+           .add('G', "degree-cache", "DIR", degreeCache,
+                "Directory for caching degree distributions.");
 
     std::set_new_handler(out_of_memory);
     std::locale::global(std::locale(""));
@@ -46,9 +49,10 @@ int main(int argc, char * const *argv)
         cout << name << ":vertex-count:" << graph.vertex_count << endl;
         cout << name << ":edge-count:" << graph.edge_count << endl;
 
+        auto props = graph.degreeProperties(degreeCache);
         for (auto p : orderings) {
             string prefix = name + ":" + p.first;
-            auto summary = graph.degreeStatistics(p.second);
+            auto summary = props.summary(p.second);
 
             cout << prefix << ":min:" << summary.min << endl;
             cout << prefix << ":lower:" << summary.lowerQuantile << endl;
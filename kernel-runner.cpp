@@ -19,11 +19,14 @@
 
 #include "Algorithm.hpp"
 #include "Backend.hpp"
+#include "CPU.hpp"
 #include "CUDA.hpp"
+#include "GraphCache.hpp"
 #include "ImplementationTemplate.hpp"
 #include "OpenCL.hpp"
 #include "options/Options.hpp"
 #include "Timer.hpp"
+#include "utils/MD5.hpp"
 #include "utils/Util.hpp"
 
 #define TO_STRING(a) xstr(a)
@@ -41,7 +44,7 @@ ImplementationTemplateBase<false>::~ImplementationTemplateBase()
 ImplementationTemplateBase<true>::~ImplementationTemplateBase()
 {}
 
-enum class framework { cuda, opencl };
+enum class framework { cuda, opencl, cpu };
 
 static map<string, Algorithm> algorithms;
 static bool debug = false;
@@ -50,10 +53,18 @@ static bool warnings = false;
 static bool noOutput = false;
 static bool printStdOut = false;
 static bool fromStdin = false;
+static size_t graphCacheSize = 0;
 static framework fw = framework::cuda;
+static string backendName;
 static int device = 0;
 static size_t platform = 0;
 static string outputDir(".");
+static string clockName("steady");
+static bool subtractOverhead = false;
+static bool traceTimers = false;
+static bool binaryTimings = false;
+static bool digestOutput = false;
+static bool digestOnly = false;
 static string algorithmName = "";
 static string kernelName = "";
 static vector<string> libPaths = { "." };
@@ -240,18 +251,36 @@ runJob
         basePath += ".timings";
 
         auto timeFile = basePath;
+        if (binaryTimings) timeFile += ".bin";
+        auto traceFile = path(basePath).replace_extension(".trace.json");
         auto outputFile = basePath.replace_extension(".output");
         if (noOutput) {
             timeFile = "/dev/null";
             outputFile = "/dev/null";
         }
 
+        string digest;
         {
             Epoch epoch(printStdOut ? "/dev/stdout" : timeFile.string(), verbose);
-            algorithm(graph, outputFile.string());
+            if (traceTimers && !noOutput) epoch.set_trace(traceFile.string());
+            epoch.set_binary(binaryTimings);
+
+            if (digestOutput || digestOnly) {
+                std::ofstream output;
+                if (!digestOnly) output.open(outputFile.string());
+
+                MD5Streambuf hashBuf(digestOnly ? nullptr : output.rdbuf());
+                static_cast<ios&>(output).rdbuf(&hashBuf);
+                algorithm(graph, std::move(output));
+                digest = hashBuf.digest.hexdigest();
+            } else {
+                algorithm(graph, outputFile.string());
+            }
         }
 
-        cout << algorithm.commit() << ":" << label << endl;
+        cout << algorithm.commit() << ":" << label;
+        if (!digest.empty()) cout << "\t" << digest;
+        cout << endl;
     }
 }
 
@@ -280,12 +309,12 @@ pin_cpu()
 
 int main(int argc, char * const *argv)
 {
-    pin_cpu();
-
     std::reference_wrapper<Backend> activeBackend(CUDA);
 
     options.add('d', "device", "NUM", device, "Device to use.")
            .add('f', "framework", fw, framework::opencl, "Use OpenCL.")
+           .add('F', "backend", "NAME", backendName,
+                "Backend to use: cuda, opencl or cpu.")
            .add('L', "lib", "PATH", libPaths, "\".\"",
                 "Search path for algorithm libraries.")
            .add('o', "output-dir", "DIR", outputDir,
@@ -297,8 +326,25 @@ int main(int argc, char * const *argv)
            .add('v', "verbose", verbose, true, "Verbose output.")
            .add('W', "warn", warnings, true, "Verbose/debug warnings.")
            .add('S', "stdin", fromStdin, true, "Read work from stdin.")
+           .add('C', "graph-cache", "MB", graphCacheSize,
+                "Memory budget for keeping graphs loaded between jobs read "
+                "from stdin, 0 (the default) disables.")
            .add('q', "quiet", noOutput, true,
-                "Inhibit creation of output and timing files.");
+                "Inhibit creation of output and timing files.")
+           .add('T', "clock", "NAME", clockName,
+                "Timer clock source: steady, monotonic-raw or tsc.")
+           .add('s', "subtract-overhead", subtractOverhead, true,
+                "Subtract the calibrated timer overhead from timings.")
+           .add('t', "trace", traceTimers, true,
+                "Write a Chrome trace of all timer intervals.")
+           .add('b', "binary-timings", binaryTimings, true,
+                "Write all raw timer samples in the binary timing format, "
+                "to a .timings.bin file.")
+           .add('D', "digest", digestOutput, true,
+                "Report the MD5 digest of the algorithm output after the "
+                "job's label.")
+           .add('X', "digest-only", digestOnly, true,
+                "Like --digest, but don't write the output file.");
 
     Options kernelParser(options);
 
@@ -318,6 +364,19 @@ int main(int argc, char * const *argv)
 
     auto optionResult = options.parseArgsNoUsage(argc, argv);
 
+    if (!backendName.empty()) {
+        if (backendName == "cuda") fw = framework::cuda;
+        else if (backendName == "opencl") fw = framework::opencl;
+        else if (backendName == "cpu") fw = framework::cpu;
+        else reportError("Unknown backend: ", backendName);
+    }
+
+    /* The CPU backend needs all cores, only pin when driving a GPU. */
+    if (fw != framework::cpu) pin_cpu();
+
+    TimerRegister::set_clock(TimerRegister::parse_clock(clockName),
+                             subtractOverhead);
+
     switch (fw) {
       case framework::opencl: {
         activeBackend = OpenCL;
@@ -335,6 +394,11 @@ int main(int argc, char * const *argv)
         algorithms = loadAlgorithms("registerCUDA", libPaths);
         break;
       }
+      case framework::cpu: {
+        activeBackend = CPU;
+        algorithms = loadAlgorithms("registerCPU", libPaths);
+        break;
+      }
     }
 
     Backend& backend = activeBackend;
@@ -364,6 +428,8 @@ int main(int argc, char * const *argv)
         wordexp_t newArgv;
         vector<string> remainingArgs;
 
+        GraphCache::get().setBudget(graphCacheSize * 1024 * 1024);
+
         while (getline(cin, line)) {
             if (wordexp(line.c_str(), &newArgv, WRDE_NOCMD | WRDE_UNDEF)) {
                 reportError("Failed to expand commandline with wordexp(3)!");
@@ -378,6 +444,8 @@ int main(int argc, char * const *argv)
             kernelParser.reset();
             wordfree(&newArgv);
         }
+
+        GraphCache::get().clear();
     } else {
         runJob(algorithmName, kernelName, optionResult.remainingArgs);
     }
@@ -1,12 +1,22 @@
+#include <fcntl.h>
 #include <getopt.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <cstring>
 
+#include <array>
+#include <atomic>
 #include <fstream>
-#include <sstream>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 
 #include <boost/filesystem.hpp>
 
 #include "utils/Graph.hpp"
+#include "utils/GraphBuilder.hpp"
 #include "utils/Util.hpp"
 
 using namespace std;
@@ -21,81 +31,297 @@ usage(int exitCode = EXIT_FAILURE)
     out << "Usage:" << endl;
     out << execName << " [--help | -h]" << endl;
     out << execName << " normalise [--directed | -d] [--undirected | -u] "
-        << "<graph> [<graphs>...]" << endl;
+        << "[--memory MB | -m MB] <graph> [<graphs>...]" << endl;
     out << execName << " mtx <graph> [<graphs>...]" << endl;
     out << execName << " edge-list <graph> [<graphs>...]" << endl;
+    out << execName << " compress <graph> [<graphs>...]" << endl;
     out << execName << " lookup <map> <id> [<id>...]" << endl;
     out << execName << " revlookup <map> <id> [<id>...]" << endl;
     exit(exitCode);
 }
 
-static size_t
-translate(unordered_map<string,uint64_t> &map, uint64_t &unique_id, string key)
-{
-    uint64_t result;
-    try {
-        result = map.at(key);
-    } catch (const out_of_range &) {
-        map.emplace(key, unique_id);
-        result = unique_id++;
+// Read-only mapping of a text graph, tokens are string_views into it.
+class MappedFile {
+    size_t size_;
+    shared_array<char> data;
+
+    static shared_array<char> map(const string& fileName, size_t& size)
+    {
+        int fd = open(fileName.c_str(), O_RDONLY);
+        if (fd == -1) {
+            perror("open");
+            dump_stack_trace(EXIT_FAILURE);
+        }
+
+        struct stat statbuf;
+        if (fstat(fd, &statbuf) != 0) {
+            perror("fstat");
+            dump_stack_trace(EXIT_FAILURE);
+        }
+        size = static_cast<size_t>(statbuf.st_size);
+
+        if (size == 0) {
+            close(fd);
+            return shared_array<char>(nullptr, [](void*) {});
+        }
+
+        void *ptr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+
+        if (ptr == MAP_FAILED) {
+            perror("mmap");
+            dump_stack_trace(EXIT_FAILURE);
+        }
+
+        madvise(ptr, size, MADV_SEQUENTIAL);
+        return shared_array<char>(ptr, [=](void *p) { munmap(p, size); });
+    }
+
+  public:
+    MappedFile(const string& fileName) : size_(0), data(map(fileName, size_))
+    {}
+
+    const char *begin() const { return data; }
+    const char *end() const { return begin() + size_; }
+    size_t size() const { return size_; }
+};
+
+// Id lookup table split into independently locked shards, so threads can
+// intern tokens concurrently. While scanning, each token maps to the offset
+// of its first occurrence, which is then replaced by its final id.
+template<typename Key>
+class ShardedIds {
+    static constexpr size_t shardCount = 64;
+
+    struct Shard {
+        mutex lock;
+        unordered_map<Key,uint64_t> ids;
+    };
+
+    array<Shard,shardCount> shards;
+
+    static size_t shardIndex(const Key& key)
+    { return (hash<Key>()(key) * 0x9E3779B97F4A7C15ULL) >> 58; }
+
+  public:
+    void intern(const Key& key, uint64_t offset)
+    {
+        Shard& s = shards[shardIndex(key)];
+        lock_guard<mutex> guard(s.lock);
+        auto [it, inserted] = s.ids.try_emplace(key, offset);
+        if (!inserted && offset < it->second) it->second = offset;
+    }
+
+    void collect(vector<pair<uint64_t,uint64_t*>>& slots)
+    {
+        for (auto& s : shards) {
+            for (auto& entry : s.ids) slots.emplace_back(entry.second, &entry.second);
+        }
     }
 
-    return result;
+    uint64_t operator[](const Key& key) const
+    { return shards[shardIndex(key)].ids.find(key)->second; }
+
+    template<typename F>
+    void forEach(F&& f) const
+    {
+        for (auto& s : shards) {
+            for (auto& [key, id] : s.ids) f(key, id);
+        }
+    }
+};
+
+// SNAP and KONECT ids are almost always plain decimal numbers, which are far
+// cheaper to hash as integers. Other tokens (including numbers with leading
+// zeroes, which are distinct ids) are kept as strings.
+class IdTable {
+    ShardedIds<uint64_t> numeric;
+    ShardedIds<string_view> other;
+
+    static bool parseId(string_view token, uint64_t& result)
+    {
+        if (token.size() > 19 || (token.size() > 1 && token[0] == '0')) {
+            return false;
+        }
+
+        result = 0;
+        for (char c : token) {
+            if (c < '0' || c > '9') return false;
+            result = result * 10 + static_cast<uint64_t>(c - '0');
+        }
+        return true;
+    }
+
+  public:
+    void intern(string_view token, uint64_t offset)
+    {
+        uint64_t id;
+        if (parseId(token, id)) numeric.intern(id, offset);
+        else other.intern(token, offset);
+    }
+
+    uint64_t operator[](string_view token) const
+    {
+        uint64_t id;
+        if (parseId(token, id)) return numeric[id];
+        return other[token];
+    }
+
+    void collect(vector<pair<uint64_t,uint64_t*>>& slots)
+    {
+        numeric.collect(slots);
+        other.collect(slots);
+    }
+
+    template<typename F>
+    void forEach(F&& f) const
+    {
+        numeric.forEach(f);
+        other.forEach(f);
+    }
+};
+
+static inline bool
+isSpace(char c)
+{ return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f'; }
+
+// Calls f(in, out) with the first two tokens of every data line in
+// [begin, end), skipping comments and lines with fewer than two tokens.
+template<typename F>
+static void
+scanEdges(const char *begin, const char *end, F&& f)
+{
+    const char *p = begin;
+    while (p < end) {
+        const char *eol = static_cast<const char*>(
+                memchr(p, '\n', static_cast<size_t>(end - p)));
+        if (!eol) eol = end;
+
+        if (*p != '#' && *p != '%') {
+            string_view tokens[2];
+            const char *q = p;
+            for (auto& token : tokens) {
+                while (q < eol && isSpace(*q)) q++;
+                const char *start = q;
+                while (q < eol && !isSpace(*q)) q++;
+                token = string_view(start, static_cast<size_t>(q - start));
+            }
+
+            if (!tokens[1].empty()) f(tokens[0], tokens[1]);
+        }
+
+        p = eol + 1;
+    }
 }
 
+// Splits [begin, end) into newline aligned chunks and processes them on all
+// hardware threads, f(chunkBegin, chunkEnd) is called once per chunk.
+template<typename F>
 static void
-normalise(const string graphName, bool undirected)
+parallelChunks(const char *begin, const char *end, F&& f)
 {
-    bool bipartite = false;
-    uint64_t inId, outId;
-    string in, out;
-    uint64_t unique_id = 0;
-    vector<Edge<uint64_t>> edges;
-    vector<Edge<uint64_t>> rev_edges;
-    unordered_map<string,uint64_t> lookup_map;
-    unordered_map<string,uint64_t> bipartite_lookup_map;
+    size_t threads = max(1U, thread::hardware_concurrency());
+    size_t size = static_cast<size_t>(end - begin);
+    size_t chunkSize = max<size_t>(1 << 20, size / (threads * 16));
+
+    vector<pair<const char*,const char*>> chunks;
+    for (const char *p = begin; p < end;) {
+        const char *chunkEnd = p + min(chunkSize, static_cast<size_t>(end - p));
+        while (chunkEnd < end && chunkEnd[-1] != '\n') chunkEnd++;
+        chunks.emplace_back(p, chunkEnd);
+        p = chunkEnd;
+    }
 
-    std::ifstream graph (graphName);
-    std::ofstream lookup_table (graphName + ".map");
+    atomic<size_t> nextChunk(0);
+    auto worker = [&]() {
+        for (size_t i; (i = nextChunk++) < chunks.size();) {
+            f(chunks[i].first, chunks[i].second);
+        }
+    };
 
-    string line;
-    string format;
-    getline(graph, line);
+    vector<thread> workers;
+    for (size_t i = 1; i < threads; i++) workers.emplace_back(worker);
+    worker();
+    for (auto& t : workers) t.join();
+}
 
-    if (line[0] == '%') {
-        if (line.find("asym") != string::npos) {
+static void
+normalise(const string graphName, bool undirected, size_t memoryBudget)
+{
+    bool bipartite = false;
+    MappedFile graph(graphName);
+    IdTable lookup_map;
+    IdTable bipartite_lookup_map;
+
+    if (graph.size() && graph.begin()[0] == '%') {
+        const char *eol = find(graph.begin(), graph.end(), '\n');
+        string_view header(graph.begin(), static_cast<size_t>(eol - graph.begin()));
+        if (header.find("asym") != string::npos) {
             undirected = false;
         } else {
             undirected = true;
-            if (line.find("bip") != string::npos) {
+            if (header.find("bip") != string::npos) {
                 bipartite = true;
             }
         }
     }
 
     auto &out_lookup_map = bipartite ? bipartite_lookup_map : lookup_map;
+    auto offset = [&](string_view token) {
+        return static_cast<uint64_t>(token.data() - graph.begin());
+    };
 
-    do {
-        istringstream ss(line);
+    parallelChunks(graph.begin(), graph.end(),
+        [&](const char *begin, const char *end) {
+            scanEdges(begin, end, [&](string_view in, string_view out) {
+                lookup_map.intern(in, offset(in));
+                out_lookup_map.intern(out, offset(out));
+            });
+        });
 
-        if (line[0] != '#' && line[0] != '%') {
-            ss >> in >> out;
-            inId = translate(lookup_map, unique_id, in);
-            outId = translate(out_lookup_map, unique_id, out);
+    // Number ids in order of first occurrence in the file.
+    vector<pair<uint64_t,uint64_t*>> slots;
+    lookup_map.collect(slots);
+    if (bipartite) bipartite_lookup_map.collect(slots);
+    sort(slots.begin(), slots.end());
 
-            edges.emplace_back(inId, outId);
-            if (undirected) edges.emplace_back(outId, inId);
-            else rev_edges.emplace_back(outId, inId);
-        }
-    } while (getline(graph, line));
+    uint64_t unique_id = 0;
+    for (auto& slot : slots) *slot.second = unique_id++;
+    vector<pair<uint64_t,uint64_t*>>().swap(slots);
+
+    size_t threads = max(1U, thread::hardware_concurrency());
+    size_t batchSize = max<size_t>(1,
+            memoryBudget / (4 * threads * sizeof(Edge<uint64_t>)));
+
+    GraphBuilder<uint64_t,uint64_t> builder(graphName, undirected, memoryBudget);
+
+    parallelChunks(graph.begin(), graph.end(),
+        [&](const char *begin, const char *end) {
+            vector<Edge<uint64_t>> batch;
+            auto flush = [&]() {
+                builder.addEdges(move(batch));
+                batch.clear();
+            };
+
+            scanEdges(begin, end, [&](string_view in, string_view out) {
+                uint64_t inId = lookup_map[in];
+                uint64_t outId = out_lookup_map[out];
 
-    string name(graphName + ".graph");
-    Graph<uint64_t,uint64_t>::output(name, edges, rev_edges);
+                batch.emplace_back(inId, outId);
+                if (undirected) batch.emplace_back(outId, inId);
 
+                if (batch.size() >= batchSize) flush();
+            });
+            flush();
+        });
+
+    builder.write(graphName + ".graph", unique_id);
+
+    std::ofstream lookup_table (graphName + ".map");
     lookup_table << unique_id << endl;
-    for (auto &pair : lookup_map) {
-        lookup_table << pair.first << "\t" << pair.second << endl;
-    }
+    lookup_map.forEach([&](const auto& key, uint64_t id) {
+        lookup_table << key << "\t" << id << '\n';
+    });
 }
 
 static void
@@ -156,13 +382,24 @@ convertEdgeList(const string graphFile)
     }
 }
 
+static void
+compressGraph(const string graphFile)
+{
+    auto filename = path(graphFile).filename()
+                  .replace_extension(".compressed.graph");
+    Graph<uint64_t,uint64_t> graph(graphFile);
+    graph.writeCompressed(filename.string());
+}
+
 int main(int argc, char **argv)
 {
     int undirected = false;
+    size_t memoryBudget = 4096;
     const char *optString = ":dm:uh?";
     static const struct option longopts[] = {
         { "directed", no_argument, &undirected, false},
         { "undirected", no_argument, &undirected, true},
+        { "memory", required_argument, nullptr, 'm' },
         { "help", no_argument, nullptr, 'h' },
         { nullptr, 0, nullptr, 0 },
     };
@@ -186,6 +423,10 @@ int main(int argc, char **argv)
                 undirected = true;
                 break;
 
+            case 'm':
+                memoryBudget = stoul(optarg);
+                break;
+
             case 'h':
             case '?':
                 usage(EXIT_SUCCESS);
@@ -206,7 +447,7 @@ int main(int argc, char **argv)
     if (argc >= 2 && !strcmp(argv[0], "normalise")) {
         for (int i = 1; i < argc; i++) {
             cout << "Normalising: " << argv[i] << endl;
-            normalise(argv[i], undirected);
+            normalise(argv[i], undirected, memoryBudget * 1024 * 1024);
         }
     } else if (argc >= 2 && !strcmp(argv[0], "mtx")) {
         for (int i = 1; i < argc; i++) {
@@ -218,6 +459,11 @@ int main(int argc, char **argv)
             cout << "Converting to edge list: " << argv[i] << endl;
             convertEdgeList(argv[i]);
         }
+    } else if (argc >= 2 && !strcmp(argv[0], "compress")) {
+        for (int i = 1; i < argc; i++) {
+            cout << "Compressing: " << argv[i] << endl;
+            compressGraph(argv[i]);
+        }
     } else if (argc >= 3 && !strcmp(argv[0], "lookup")) {
         lookup(argv[1], false, argc - 2, &argv[2]);
     } else if (argc >= 3 && !strcmp(argv[0], "revlookup")) {
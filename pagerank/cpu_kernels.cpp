@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <cmath>
+
+#include "CPU.hpp"
+#include "cpu_kernels.hpp"
+#include "pagerank.hpp"
+
+static float diff = 0.0f;
+
+void resetCPUDiff()
+{
+    const float val = 0.0f;
+    __atomic_store(&diff, &val, __ATOMIC_RELAXED);
+}
+
+float getCPUDiff()
+{ return CPUBackend::atomicLoad(&diff); }
+
+void
+cpuZeroInitDegrees(size_t count, unsigned *degrees)
+{
+    auto [start, end] = CPUBackend::blockRange(count);
+    std::fill(degrees + start, degrees + end, 0U);
+}
+
+void
+cpuEdgeListComputeDegrees(EdgeList<unsigned> *graph, unsigned *degrees)
+{
+    auto [start, end] = CPUBackend::blockRange(graph->edge_count);
+    unsigned *edgeOrigins = graph->inEdges;
+
+    for (uint64_t idx = start; idx < end; idx++) {
+        CPUBackend::atomicAdd(&degrees[edgeOrigins[idx]], 1U);
+    }
+}
+
+void
+cpuStructEdgeListComputeDegrees
+(StructEdgeList<unsigned> *graph, unsigned *degrees)
+{
+    auto [start, end] = CPUBackend::blockRange(graph->edge_count);
+    edge<unsigned> *edges = graph->edges;
+
+    for (uint64_t idx = start; idx < end; idx++) {
+        CPUBackend::atomicAdd(&degrees[edges[idx].in], 1U);
+    }
+}
+
+void
+cpuReverseEdgeListComputeDegrees(EdgeList<unsigned> *graph, unsigned *degrees)
+{
+    auto [start, end] = CPUBackend::blockRange(graph->edge_count);
+    unsigned *edgeOrigins = graph->outEdges;
+
+    for (uint64_t idx = start; idx < end; idx++) {
+        CPUBackend::atomicAdd(&degrees[edgeOrigins[idx]], 1U);
+    }
+}
+
+void
+cpuReverseStructEdgeListComputeDegrees
+(StructEdgeList<unsigned> *graph, unsigned *degrees)
+{
+    auto [start, end] = CPUBackend::blockRange(graph->edge_count);
+    edge<unsigned> *edges = graph->edges;
+
+    for (uint64_t idx = start; idx < end; idx++) {
+        CPUBackend::atomicAdd(&degrees[edges[idx].out], 1U);
+    }
+}
+
+void
+cpuReverseCSRComputeDegrees(CSR<unsigned,unsigned> *graph, unsigned *degrees)
+{
+    auto [start, end] = CPUBackend::blockRange(graph->vertex_count);
+    unsigned *vertices = graph->vertices;
+    unsigned *edges = graph->edges;
+
+    for (uint64_t idx = start; idx < end; idx++) {
+        for (unsigned i = vertices[idx]; i < vertices[idx + 1]; i++) {
+            CPUBackend::atomicAdd(&degrees[edges[i]], 1U);
+        }
+    }
+}
+
+void
+cpuConsolidateRank
+(size_t size, unsigned*, float *pagerank, float *new_pagerank, bool)
+{
+    auto [start, end] = CPUBackend::blockRange(size);
+    float blockDiff = 0.0f;
+
+    for (uint64_t idx = start; idx < end; idx++) {
+        float new_rank = ((1.0f - dampening) / size) + (dampening * new_pagerank[idx]);
+        blockDiff += std::fabs(new_rank - pagerank[idx]);
+
+        pagerank[idx] = new_rank;
+        new_pagerank[idx] = 0.0f;
+    }
+
+    CPUBackend::atomicAdd(&diff, blockDiff);
+}
+
+void
+cpuConsolidateRankNoDiv
+( size_t size
+, unsigned* degrees
+, float *pagerank
+, float *new_pagerank
+, bool notLast
+)
+{
+    auto [start, end] = CPUBackend::blockRange(size);
+    float blockDiff = 0.0f;
+
+    for (uint64_t idx = start; idx < end; idx++) {
+        float new_rank = ((1.0f - dampening) / size) + (dampening * new_pagerank[idx]);
+        blockDiff += std::fabs(new_rank - pagerank[idx]);
+
+        unsigned degree = degrees[idx];
+
+        if (degree != 0 && notLast) new_rank = new_rank / degree;
+        pagerank[idx] = new_rank;
+        new_pagerank[idx] = 0.0f;
+    }
+
+    CPUBackend::atomicAdd(&diff, blockDiff);
+}
+
+static inline void
+pushRank
+( unsigned origin
+, unsigned destination
+, unsigned *degrees
+, float *pagerank
+, float *new_pagerank
+)
+{
+    unsigned degree = degrees[origin];
+    float new_rank = 0.0f;
+    if (degree != 0) new_rank = pagerank[origin] / degree;
+    CPUBackend::atomicAdd(&new_pagerank[destination], new_rank);
+}
+
+void
+cpuEdgeListPageRank
+( EdgeList<unsigned> *graph
+, unsigned *degrees
+, float *pagerank
+, float *new_pagerank
+)
+{
+    auto [start, end] = CPUBackend::blockRange(graph->edge_count);
+
+    for (uint64_t idx = start; idx < end; idx++) {
+        pushRank(graph->inEdges[idx], graph->outEdges[idx], degrees, pagerank,
+                 new_pagerank);
+    }
+}
+
+void
+cpuRevEdgeListPageRank
+( EdgeList<unsigned> *graph
+, unsigned *degrees
+, float *pagerank
+, float *new_pagerank
+)
+{
+    auto [start, end] = CPUBackend::blockRange(graph->edge_count);
+
+    for (uint64_t idx = start; idx < end; idx++) {
+        pushRank(graph->outEdges[idx], graph->inEdges[idx], degrees, pagerank,
+                 new_pagerank);
+    }
+}
+
+void
+cpuStructEdgeListPageRank
+( StructEdgeList<unsigned> *graph
+, unsigned *degrees
+, float *pagerank
+, float *new_pagerank
+)
+{
+    auto [start, end] = CPUBackend::blockRange(graph->edge_count);
+
+    for (uint64_t idx = start; idx < end; idx++) {
+        edge<unsigned> myEdge = graph->edges[idx];
+        pushRank(myEdge.in, myEdge.out, degrees, pagerank, new_pagerank);
+    }
+}
+
+void
+cpuRevStructEdgeListPageRank
+( StructEdgeList<unsigned> *graph
+, unsigned *degrees
+, float *pagerank
+, float *new_pagerank
+)
+{
+    auto [start, end] = CPUBackend::blockRange(graph->edge_count);
+
+    for (uint64_t idx = start; idx < end; idx++) {
+        edge<unsigned> myEdge = graph->edges[idx];
+        pushRank(myEdge.out, myEdge.in, degrees, pagerank, new_pagerank);
+    }
+}
+
+void
+cpuVertexPushPageRank
+( CSR<unsigned,unsigned> *graph
+, unsigned *
+, float *pagerank
+, float *new_pagerank
+)
+{
+    auto [start, end] = CPUBackend::blockRange(graph->vertex_count);
+    unsigned *vertices = graph->vertices;
+    unsigned *edges = graph->edges;
+
+    for (uint64_t idx = start; idx < end; idx++) {
+        unsigned degree = vertices[idx + 1] - vertices[idx];
+        if (degree == 0) continue;
+
+        float outgoingRank = pagerank[idx] / degree;
+        for (unsigned i = vertices[idx]; i < vertices[idx + 1]; i++) {
+            CPUBackend::atomicAdd(&new_pagerank[edges[i]], outgoingRank);
+        }
+    }
+}
+
+void
+cpuVertexPullPageRank
+( CSR<unsigned,unsigned> *graph
+, unsigned *degrees
+, float *pagerank
+, float *new_pagerank
+)
+{
+    auto [start, end] = CPUBackend::blockRange(graph->vertex_count);
+    unsigned *rev_vertices = graph->vertices;
+    unsigned *rev_edges = graph->edges;
+
+    for (uint64_t idx = start; idx < end; idx++) {
+        float newRank = 0.0f;
+
+        for (unsigned i = rev_vertices[idx]; i < rev_vertices[idx + 1]; i++) {
+            unsigned rev_edge = rev_edges[i];
+            newRank += pagerank[rev_edge] / degrees[rev_edge];
+        }
+
+        new_pagerank[idx] = newRank;
+    }
+}
+
+void
+cpuVertexPullNoDivPageRank
+( CSR<unsigned,unsigned> *graph
+, unsigned *
+, float *pagerank
+, float *new_pagerank
+)
+{
+    auto [start, end] = CPUBackend::blockRange(graph->vertex_count);
+    unsigned *rev_vertices = graph->vertices;
+    unsigned *rev_edges = graph->edges;
+
+    for (uint64_t idx = start; idx < end; idx++) {
+        float newRank = 0.0f;
+
+        for (unsigned i = rev_vertices[idx]; i < rev_vertices[idx + 1]; i++) {
+            newRank += pagerank[rev_edges[i]];
+        }
+
+        new_pagerank[idx] = newRank;
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef PAGERANK_CPU_KERNELS_HPP
+#define PAGERANK_CPU_KERNELS_HPP
+
+#include <cstddef>
+
+#include "GraphRep.hpp"
+
+void resetCPUDiff();
+float getCPUDiff();
+
+void
+cpuZeroInitDegrees(size_t vertexCount, unsigned *degrees);
+
+void
+cpuEdgeListComputeDegrees(EdgeList<unsigned> *graph, unsigned *degrees);
+
+void
+cpuStructEdgeListComputeDegrees
+(StructEdgeList<unsigned> *graph, unsigned *degrees);
+
+void
+cpuReverseEdgeListComputeDegrees(EdgeList<unsigned> *graph, unsigned *degrees);
+
+void
+cpuReverseStructEdgeListComputeDegrees
+(StructEdgeList<unsigned> *graph, unsigned *degrees);
+
+void
+cpuReverseCSRComputeDegrees(CSR<unsigned,unsigned> *graph, unsigned *degrees);
+
+void
+cpuConsolidateRank
+(size_t, unsigned *degrees, float *pagerank, float *new_pagerank, bool);
+
+void
+cpuConsolidateRankNoDiv
+(size_t, unsigned *degrees, float *pagerank, float *new_pagerank, bool);
+
+void
+cpuEdgeListPageRank
+( EdgeList<unsigned> *graph
+, unsigned *degrees
+, float *pagerank
+, float *new_pagerank
+);
+
+void
+cpuRevEdgeListPageRank
+( EdgeList<unsigned> *graph
+, unsigned *degrees
+, float *pagerank
+, float *new_pagerank
+);
+
+void
+cpuStructEdgeListPageRank
+( StructEdgeList<unsigned> *graph
+, unsigned *degrees
+, float *pagerank
+, float *new_pagerank
+);
+
+void
+cpuRevStructEdgeListPageRank
+( StructEdgeList<unsigned> *graph
+, unsigned *degrees
+, float *pagerank
+, float *new_pagerank
+);
+
+void
+cpuVertexPushPageRank
+( CSR<unsigned,unsigned> *graph
+, unsigned *degrees
+, float *pagerank
+, float *new_pagerank
+);
+
+void
+cpuVertexPullPageRank
+( CSR<unsigned,unsigned> *graph
+, unsigned *degrees
+, float *pagerank
+, float *new_pagerank
+);
+
+void
+cpuVertexPullNoDivPageRank
+( CSR<unsigned,unsigned> *graph
+, unsigned *degrees
+, float *pagerank
+, float *new_pagerank
+);
+#endif
@@ -1,14 +1,28 @@
 #include <algorithm>
 #include <fstream>
-#include <iomanip>
 
 #include "Algorithm.hpp"
+#include "CPU.hpp"
 #include "CUDA.hpp"
 #include "ImplementationTemplate.hpp"
+#include "ResultWriter.hpp"
 #include "Timer.hpp"
 
+#include "cpu_kernels.hpp"
 #include "pagerank.hpp"
 
+template<typename Platform>
+struct Diff {
+    static void reset() { resetDiff(); }
+    static float get() { return getDiff(); }
+};
+
+template<>
+struct Diff<CPUBackend> {
+    static void reset() { resetCPUDiff(); }
+    static float get() { return getCPUDiff(); }
+};
+
 static inline uint32_t
 mask_N_bits(unsigned N)
 {
@@ -115,13 +129,13 @@ struct PageRank : public ImplementationTemplate<Platform,Vertex,Edge,switching>
             int j = 0;
             do {
                 j++;
-                resetDiff();
+                Diff<Platform>::reset();
                 setKernelConfig(kernel);
                 kernel(this->loader, degrees, pageranks, new_pageranks);
                 setKernelConfig(consolidate);
                 consolidate(this->loader, degrees, pageranks, new_pageranks, max_iterations > j);
 
-                diff = getDiff();
+                diff = Diff<Platform>::get();
             } while (j < max_iterations);
             pagerankStepTime.stop();
             pagerankTime.stop();
@@ -131,17 +145,11 @@ struct PageRank : public ImplementationTemplate<Platform,Vertex,Edge,switching>
             resultTransfer.stop();
         }
 
-        auto oldLocale = outputFile.imbue(std::locale("C"));
+        ResultWriter writer(outputFile, this->binaryOutput);
         if (validate) {
             auto floatDigits = std::numeric_limits<float>::digits10 + 1;
-            outputFile << std::setprecision(floatDigits);
-
-            for (size_t i = 0; i < pageranks.size; i++) {
-                outputFile << i << "\t" << pageranks[i] << endl;
-            }
+            writer.writeIndexed(pageranks, pageranks.size, floatDigits);
         } else {
-            outputFile << std::hexfloat;
-
             uint32_t mask = mask_N_bits(maskBits);
 
             std::vector<std::pair<float,size_t>> buckets;
@@ -162,12 +170,10 @@ struct PageRank : public ImplementationTemplate<Platform,Vertex,Edge,switching>
                 std::stable_sort(start, end, compare);
             }
 
-            for (const auto& p : buckets) {
-                outputFile << p.second << endl;
-            }
+            writer.writeValues<uint64_t>(buckets.size(), [&](size_t i) {
+                return buckets[i].second;
+            });
         }
-
-        outputFile.imbue(oldLocale);
     }
 };
 
@@ -356,3 +362,145 @@ extern "C" void registerCUDA(Algorithm& result)
 
     result.addImplementation("switch", make_switch_implementation<PageRank>(prMap));
 }
+
+extern "C" register_algorithm_t registerCPU;
+extern "C" void registerCPU(Algorithm& result)
+{
+    INITIALISE_ALGORITHM(result);
+    KernelBuilder<CPUBackend,unsigned,unsigned> make_kernel;
+
+    auto zeroInitDegrees = make_kernel
+        ( cpuZeroInitDegrees
+        , work_division::vertex
+        , tag_t(Rep::VertexCount)
+        );
+
+    auto reverseCSRDegrees = make_kernel
+        ( cpuReverseCSRComputeDegrees
+        , work_division::vertex
+        , tag_t(Rep::CSR)
+        , tag_t(Dir::Reverse)
+        );
+
+    auto consolidate = make_kernel
+        ( cpuConsolidateRank
+        , work_division::vertex
+        , tag_t(Rep::VertexCount)
+        );
+
+    auto consolidateNoDiv = make_kernel
+        ( cpuConsolidateRankNoDiv
+        , work_division::vertex
+        , tag_t(Rep::VertexCount)
+        );
+
+    KernelMap prMap
+    { std::pair
+        { "edge-list"
+        , std::tuple
+            { make_kernel
+                ( cpuEdgeListPageRank
+                , work_division::edge
+                , tag_t(Rep::EdgeList)
+                )
+            , consolidate
+            , zeroInitDegrees
+            , make_kernel
+                ( cpuEdgeListComputeDegrees
+                , work_division::edge
+                , tag_t(Rep::EdgeList)
+                )
+            }
+        }
+    };
+
+    prMap["rev-edge-list"] =
+        { make_kernel
+            ( cpuRevEdgeListPageRank
+            , work_division::edge
+            , tag_t(Rep::EdgeList)
+            , tag_t(Dir::Reverse)
+            )
+        , consolidate
+        , zeroInitDegrees
+        , make_kernel
+            ( cpuReverseEdgeListComputeDegrees
+            , work_division::edge
+            , tag_t(Rep::EdgeList)
+            , tag_t(Dir::Reverse)
+            )
+        };
+
+    prMap["struct-edge-list"] =
+        { make_kernel
+            ( cpuStructEdgeListPageRank
+            , work_division::edge
+            , tag_t(Rep::StructEdgeList)
+            )
+        , consolidate
+        , zeroInitDegrees
+        , make_kernel
+            ( cpuStructEdgeListComputeDegrees
+            , work_division::edge
+            , tag_t(Rep::StructEdgeList)
+            )
+        };
+
+    prMap["rev-struct-edge-list"] =
+        { make_kernel
+            ( cpuRevStructEdgeListPageRank
+            , work_division::edge
+            , tag_t(Rep::StructEdgeList)
+            , tag_t(Dir::Reverse)
+            )
+        , consolidate
+        , zeroInitDegrees
+        , make_kernel
+            ( cpuReverseStructEdgeListComputeDegrees
+            , work_division::edge
+            , tag_t(Rep::StructEdgeList)
+            , tag_t(Dir::Reverse)
+            )
+        };
+
+    prMap["vertex-push"] = std::make_tuple
+        ( make_kernel
+            ( cpuVertexPushPageRank
+            , work_division::vertex
+            , tag_t(Rep::CSR)
+            )
+        , consolidate
+        , nullptr
+        , nullptr
+        );
+
+    prMap["vertex-pull"] =
+        { make_kernel
+            ( cpuVertexPullPageRank
+            , work_division::vertex
+            , tag_t(Rep::CSR)
+            , tag_t(Dir::Reverse)
+            )
+        , consolidate
+        , zeroInitDegrees
+        , reverseCSRDegrees
+        };
+
+    prMap["vertex-pull-nodiv"] =
+        { make_kernel
+            ( cpuVertexPullNoDivPageRank
+            , work_division::vertex
+            , tag_t(Rep::CSR)
+            , tag_t(Dir::Reverse)
+            )
+        , consolidateNoDiv
+        , zeroInitDegrees
+        , reverseCSRDegrees
+        };
+
+    for (auto& [name, kernel] : prMap) {
+        result.addImplementation(name, make_implementation<PageRank>(kernel));
+    }
+
+    result.addImplementation("switch", make_switch_implementation<PageRank>(prMap));
+}
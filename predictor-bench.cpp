@@ -0,0 +1,83 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "DecisionTree.hpp"
+#include "options/Options.hpp"
+#include "utils/Util.hpp"
+
+using namespace std;
+
+static const char *exeName = "predictor-bench";
+static Options options('h', "help", cout, [](ostream& out)
+{
+    out << "Usage:" << endl;
+    out << "    " << exeName << " tree-file [tree-files...]" << endl << endl;
+    out << "Measures the latency of decision tree lookups for random "
+        << "property values around the tree's thresholds." << endl << endl;
+    out << "Options:" << endl;
+});
+
+int main(int argc, char * const *argv)
+{
+    size_t lookups = 10000000;
+    size_t inputs = 4096;
+    unsigned seed = 42;
+
+    options.add('n', "lookups", "NUM", lookups, "Number of lookups to time.")
+           .add('i', "inputs", "NUM", inputs,
+                "Number of distinct property vectors to cycle through.")
+           .add('s', "seed", "NUM", seed, "Seed for the property values.");
+
+    std::set_new_handler(out_of_memory);
+    auto files = options.parseArgs(argc, argv);
+    if (files.empty() || !inputs) {
+        options.usage(cerr);
+        return EXIT_FAILURE;
+    }
+
+    for (auto& file : files) {
+        DecisionTree tree;
+        tree.load(file);
+
+        auto splits = tree.splits();
+        size_t propCount = tree.properties.size();
+
+        // Each property is drawn near a random threshold of a split on it,
+        // so lookups take both branches and follow varying paths.
+        mt19937_64 rng(seed);
+        uniform_real_distribution<double> scale(0.5, 1.5);
+        vector<vector<double>> candidates(propCount);
+        for (auto& [prop, threshold] : splits) {
+            candidates[prop].push_back(threshold);
+        }
+
+        vector<double> values(inputs * propCount, 0.0);
+        for (size_t i = 0; i < inputs; i++) {
+            for (size_t p = 0; p < propCount; p++) {
+                auto& thresholds = candidates[p];
+                if (thresholds.empty()) continue;
+
+                uniform_int_distribution<size_t> pick(0, thresholds.size() - 1);
+                values[i * propCount + p] = thresholds[pick(rng)] * scale(rng);
+            }
+        }
+
+        int64_t checksum = 0;
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0, input = 0; i < lookups; i++) {
+            copy_n(values.begin() + static_cast<long>(input * propCount),
+                   propCount, tree.properties.begin());
+            checksum += tree.lookup();
+            if (++input == inputs) input = 0;
+        }
+        auto end = chrono::steady_clock::now();
+
+        double nanos = chrono::duration<double, nano>(end - start).count();
+        cout << file << ": " << splits.size() << " splits, "
+             << nanos / static_cast<double>(lookups) << " ns per lookup "
+             << "(checksum " << checksum << ")" << endl;
+    }
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include <fcntl.h>
+#include <getopt.h>
 #include <unistd.h>
 
 #include <sys/mman.h>
@@ -9,11 +10,14 @@
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 #include "utils/Util.hpp"
 #include "utils/Graph.hpp"
+#include "utils/GraphBuilder.hpp"
 
 #define CEIL_DIV(x, y)          (((x) + ((y) - 1)) / (y))
 
@@ -37,13 +41,14 @@ enum sort_order {
     abs_degree
 };
 
+template<typename V>
 static void
-messupSort(std::vector<VertexDegree<uint64_t>>& vertices)
+messupSort(std::vector<VertexDegree<V>>& vertices)
 {
     ssize_t numWarps = CEIL_DIV(vertices.size(), 32);
     auto start = vertices.begin();
     auto end = vertices.end();
-    std::vector<VertexDegree<uint64_t>> tmpVector;
+    std::vector<VertexDegree<V>> tmpVector;
 
     advance(start, numWarps);
     advance(end, -numWarps);
@@ -61,33 +66,57 @@ messupSort(std::vector<VertexDegree<uint64_t>>& vertices)
     vertices = tmpVector;
 }
 
+template<typename V, typename E>
 static void
-sortGraph
-(Graph<uint64_t,uint64_t>& graph, string fileName, sort_order order, bool worst)
+relabelEdges
+( GraphBuilder<V,E>& result
+, const vector<E>& lookup
+, const Accessor<V>& raw_vertices
+, const Accessor<E>& raw_edges
+)
 {
-    vector<VertexDegree<uint64_t>> newOrder;
-    newOrder.reserve(graph.vertex_count);
-
-    for (uint64_t v = 0; v < graph.vertex_count; v++) {
-        uint64_t degree;
-
-        switch (order) {
-            case in_degree:
-                degree = graph.raw_rev_vertices[v + 1] - graph.raw_rev_vertices[v];
-                break;
-            case out_degree:
-                degree = graph.raw_vertices[v + 1] - graph.raw_vertices[v];
-                break;
-            case abs_degree:
-                degree = graph.raw_vertices[v + 1] - graph.raw_vertices[v];
-                degree += graph.raw_rev_vertices[v + 1] - graph.raw_rev_vertices[v];
-                break;
-        }
+    raw_vertices.visit([&](auto vertices) {
+        raw_edges.visit([&](auto edges) {
+            for (uint64_t v = 0; v + 1 < raw_vertices.size; v++) {
+                for (uint64_t i = vertices[v]; i < vertices[v + 1]; i++) {
+                    result.emplace_back(lookup[v], lookup[edges[i]]);
+                }
+            }
+        });
+    });
+}
 
-        newOrder.emplace_back(v, degree);
-    }
+template<typename V, typename E>
+static vector<E>
+degreeOrder(Graph<V,E>& graph, sort_order order, bool worst)
+{
+    vector<VertexDegree<E>> newOrder;
+    newOrder.reserve(graph.vertex_count);
 
-    using Degree = VertexDegree<uint64_t>;
+    graph.raw_vertices.visit([&](auto vertices) {
+        graph.raw_rev_vertices.visit([&](auto rev_vertices) {
+            for (uint64_t v = 0; v < graph.vertex_count; v++) {
+                uint64_t degree = 0;
+
+                switch (order) {
+                    case in_degree:
+                        degree = rev_vertices[v + 1] - rev_vertices[v];
+                        break;
+                    case out_degree:
+                        degree = vertices[v + 1] - vertices[v];
+                        break;
+                    case abs_degree:
+                        degree = vertices[v + 1] - vertices[v];
+                        degree += rev_vertices[v + 1] - rev_vertices[v];
+                        break;
+                }
+
+                newOrder.emplace_back(static_cast<E>(v), degree);
+            }
+        });
+    });
+
+    using Degree = VertexDegree<E>;
 
     auto cmp = [](const Degree &a, const Degree &b) {
         if (a.degree > b.degree) return true;
@@ -98,33 +127,498 @@ sortGraph
     stable_sort(newOrder.begin(), newOrder.end(), cmp);
     if (worst) messupSort(newOrder);
 
+    vector<E> result;
+    result.reserve(newOrder.size());
+    for (auto& vertex : newOrder) result.push_back(vertex.vertexId);
+    return result;
+}
+
+// Runs f(begin, end) over [0, count) split into one range per hardware
+// thread.
+template<typename F>
+static void
+parallelFor(uint64_t count, F&& f)
+{
+    uint64_t threads = max(1U, thread::hardware_concurrency());
+    uint64_t step = CEIL_DIV(count, threads);
+
+    vector<thread> workers;
+    for (uint64_t begin = step; begin < count; begin += step) {
+        workers.emplace_back(f, begin, min(count, begin + step));
+    }
+    f(0, min(count, step));
+    for (auto& t : workers) t.join();
+}
+
+// Symmetric adjacency (out and in edges combined) used by the locality
+// orderings, which only care about which vertices are connected.
+template<typename E>
+struct Neighbours
+{
+    vector<uint64_t> offsets;
+    vector<E> edges;
+
+    Neighbours() {}
+
+    template<typename V>
+    Neighbours(Graph<V,E>& graph) : offsets(graph.vertex_count + 1, 0)
+    {
+        bool both = !graph.undirected;
+        uint64_t vertex_count = graph.vertex_count;
+
+        graph.raw_vertices.visit([&](auto vertices) {
+            graph.raw_rev_vertices.visit([&](auto rev_vertices) {
+                for (uint64_t v = 0; v < vertex_count; v++) {
+                    uint64_t degree = vertices[v + 1] - vertices[v];
+                    if (both) degree += rev_vertices[v + 1] - rev_vertices[v];
+                    offsets[v + 1] = offsets[v] + degree;
+                }
+            });
+        });
+
+        edges.resize(offsets.back());
+        auto copy = [&](const Accessor<V>& raw_vertices,
+                        const Accessor<E>& raw_edges, bool second)
+        {
+            raw_vertices.visit([&](auto vertices) {
+                raw_edges.visit([&](auto edgeData) {
+                    parallelFor(vertex_count, [&](uint64_t first, uint64_t last) {
+                        for (uint64_t v = first; v < last; v++) {
+                            uint64_t out = offsets[v];
+                            if (second) {
+                                out = offsets[v + 1] - (vertices[v + 1] - vertices[v]);
+                            }
+                            auto begin = edgeData + vertices[v];
+                            auto end = edgeData + vertices[v + 1];
+                            copy_n(begin, end - begin, &edges[out]);
+                        }
+                    });
+                });
+            });
+        };
+
+        copy(graph.raw_vertices, graph.raw_edges, false);
+        if (both) copy(graph.raw_rev_vertices, graph.raw_rev_edges, true);
+    }
+
+    uint64_t size() const
+    { return offsets.size() - 1; }
+
+    uint64_t degree(uint64_t v) const
+    { return offsets[v + 1] - offsets[v]; }
+
+    const E* begin(uint64_t v) const
+    { return edges.data() + offsets[v]; }
+
+    const E* end(uint64_t v) const
+    { return edges.data() + offsets[v + 1]; }
+};
+
+// Vertices sorted by symmetric degree, used to pick BFS roots.
+template<typename E>
+static vector<E>
+verticesByDegree(const Neighbours<E>& adj, bool descending)
+{
+    vector<E> result(adj.size());
+    for (uint64_t v = 0; v < adj.size(); v++) result[v] = static_cast<E>(v);
+
+    stable_sort(result.begin(), result.end(), [&](E a, E b) {
+        if (descending) return adj.degree(a) > adj.degree(b);
+        return adj.degree(a) < adj.degree(b);
+    });
+    return result;
+}
+
+// BFS order rooted at the highest degree vertex of each component. With
+// cuthillMcKee, roots are the lowest degree vertices, neighbours are visited
+// in increasing degree and the final order is reversed (RCM).
+template<typename E>
+static vector<E>
+bfsOrder(const Neighbours<E>& adj, bool cuthillMcKee)
+{
+    vector<E> result;
+    vector<bool> visited(adj.size(), false);
+    result.reserve(adj.size());
+
+    auto byDegree = [&](E a, E b) { return adj.degree(a) < adj.degree(b); };
+
+    for (E root : verticesByDegree(adj, !cuthillMcKee)) {
+        if (visited[root]) continue;
+
+        visited[root] = true;
+        result.push_back(root);
+        for (uint64_t head = result.size() - 1; head < result.size(); head++) {
+            uint64_t frontier = result.size();
+            E v = result[head];
+
+            for (auto it = adj.begin(v); it != adj.end(v); ++it) {
+                if (!visited[*it]) {
+                    visited[*it] = true;
+                    result.push_back(*it);
+                }
+            }
+
+            if (cuthillMcKee) {
+                stable_sort(result.begin() + static_cast<int64_t>(frontier),
+                            result.end(), byDegree);
+            }
+        }
+    }
+
+    if (cuthillMcKee) reverse(result.begin(), result.end());
+    return result;
+}
+
+// Hub clustering: vertices with above average degree are grouped at the
+// front, otherwise the original order is kept.
+template<typename E>
+static vector<E>
+hubOrder(const Neighbours<E>& adj)
+{
+    vector<E> result(adj.size());
+    for (uint64_t v = 0; v < adj.size(); v++) result[v] = static_cast<E>(v);
+
+    double average = adj.size() ? static_cast<double>(adj.edges.size())
+                                  / static_cast<double>(adj.size()) : 0;
+
+    stable_partition(result.begin(), result.end(), [&](E v) {
+        return static_cast<double>(adj.degree(v)) > average;
+    });
+    return result;
+}
+
+// Vertices bucketed by integer score, supporting constant time score updates
+// and extraction of a maximum score vertex (the "unit heap" from Gorder).
+template<typename E>
+class ScoreBuckets
+{
+    static constexpr int64_t none = -1;
+
+    vector<int64_t> next, prev, head;
+    vector<uint64_t> score;
+    uint64_t top;
+
+    void unlink(E v)
+    {
+        if (prev[v] != none) next[static_cast<uint64_t>(prev[v])] = next[v];
+        else head[score[v]] = next[v];
+        if (next[v] != none) prev[static_cast<uint64_t>(next[v])] = prev[v];
+    }
+
+    void link(E v)
+    {
+        if (score[v] >= head.size()) head.resize(score[v] + 1, none);
+        prev[v] = none;
+        next[v] = head[score[v]];
+        if (next[v] != none) prev[static_cast<uint64_t>(next[v])] = v;
+        head[score[v]] = v;
+        top = max(top, score[v]);
+    }
+
+  public:
+    ScoreBuckets(uint64_t n)
+      : next(n, none), prev(n, none), head(1, none), score(n, 0), top(0)
+    { for (uint64_t v = n; v > 0; v--) link(static_cast<E>(v - 1)); }
+
+    void adjust(E v, int64_t delta)
+    {
+        unlink(v);
+        score[v] = static_cast<uint64_t>(static_cast<int64_t>(score[v]) + delta);
+        link(v);
+    }
+
+    void erase(E v)
+    { unlink(v); }
+
+    // Returns a vertex with the highest positive score, or none.
+    int64_t best()
+    {
+        while (top > 0 && head[top] == none) top--;
+        return top > 0 ? head[top] : none;
+    }
+};
+
+// Gorder: greedily appends the vertex with the most neighbours and shared
+// neighbours among the last window placed vertices. Sibling scores are not
+// propagated through hubs (degree above sqrt(n)) to bound the cost.
+template<typename E>
+static vector<E>
+gOrder(const Neighbours<E>& adj, uint64_t window)
+{
+    uint64_t vertex_count = adj.size();
+    uint64_t hubDegree = static_cast<uint64_t>(sqrt(vertex_count)) + 1;
+
+    vector<E> result;
+    vector<bool> placed(vertex_count, false);
+    ScoreBuckets<E> scores(vertex_count);
+    result.reserve(vertex_count);
+
+    auto update = [&](E v, int64_t delta) {
+        auto bump = [&](E u) { if (!placed[u]) scores.adjust(u, delta); };
+
+        for (auto it = adj.begin(v); it != adj.end(v); ++it) {
+            bump(*it);
+            if (adj.degree(*it) > hubDegree) continue;
+            for (auto sib = adj.begin(*it); sib != adj.end(*it); ++sib) {
+                if (*sib != v) bump(*sib);
+            }
+        }
+    };
+
+    auto roots = verticesByDegree(adj, true);
+    auto root = roots.begin();
+
+    while (result.size() < vertex_count) {
+        int64_t best = scores.best();
+        if (best < 0) {
+            while (placed[*root]) ++root;
+            best = *root;
+        }
+
+        E v = static_cast<E>(best);
+        placed[v] = true;
+        scores.erase(v);
+        result.push_back(v);
+
+        update(v, 1);
+        if (result.size() > window) {
+            update(result[result.size() - window - 1], -1);
+        }
+    }
+
+    return result;
+}
+
+// Recursive graph bisection (Dhulipala et al., KDD 2016): splits the vertices
+// in two halves and swaps vertices between them to minimise the log gap cost
+// of their neighbourhoods, then recurses on both halves in parallel.
+template<typename E>
+class Bisection
+{
+    static constexpr uint64_t leafSize = 64;
+    static constexpr int iterations = 20;
+
+    const Neighbours<E>& adj;
+    uint64_t neighbourCount;
+    vector<double> logs;
+
+    struct Scratch {
+        vector<uint32_t> left, right;
+
+        Scratch(uint64_t n) : left(n, 0), right(n, 0) {}
+    };
+
+    // Log gap cost of count neighbours within a part of log2(size) = logSize.
+    double cost(uint32_t count, double logSize) const
+    { return count * (logSize - logs[count + 1]); }
+
+    void count(E *first, E *last, vector<uint32_t>& side, int dir)
+    {
+        for (E *v = first; v != last; ++v) {
+            for (auto it = adj.begin(*v); it != adj.end(*v); ++it) {
+                side[*it] += static_cast<uint32_t>(dir);
+            }
+        }
+    }
+
+    void split(Scratch& s, E *first, E *last)
+    {
+        E *mid = first + (last - first) / 2;
+        double leftSize = log2(static_cast<double>(mid - first));
+        double rightSize = log2(static_cast<double>(last - mid));
+
+        count(first, mid, s.left, 1);
+        count(mid, last, s.right, 1);
+
+        auto gain = [&](E v, bool fromLeft) {
+            double result = 0;
+            for (auto it = adj.begin(v); it != adj.end(v); ++it) {
+                uint32_t l = s.left[*it], r = s.right[*it];
+                double before = cost(l, leftSize) + cost(r, rightSize);
+                double after = fromLeft
+                    ? cost(l - 1, leftSize) + cost(r + 1, rightSize)
+                    : cost(l + 1, leftSize) + cost(r - 1, rightSize);
+                result += before - after;
+            }
+            return result;
+        };
+
+        vector<pair<double,E*>> leftGains, rightGains;
+        for (int iter = 0; iter < iterations; iter++) {
+            leftGains.clear();
+            rightGains.clear();
+            for (E *v = first; v != mid; ++v) leftGains.emplace_back(gain(*v, true), v);
+            for (E *v = mid; v != last; ++v) rightGains.emplace_back(gain(*v, false), v);
+
+            auto desc = [](auto& a, auto& b) { return a.first > b.first; };
+            sort(leftGains.begin(), leftGains.end(), desc);
+            sort(rightGains.begin(), rightGains.end(), desc);
+
+            uint64_t swaps = 0;
+            while (swaps < leftGains.size() && swaps < rightGains.size()
+                && leftGains[swaps].first + rightGains[swaps].first > 0) {
+                E *l = leftGains[swaps].second, *r = rightGains[swaps].second;
+                for (auto it = adj.begin(*l); it != adj.end(*l); ++it) {
+                    s.left[*it]--;
+                    s.right[*it]++;
+                }
+                for (auto it = adj.begin(*r); it != adj.end(*r); ++it) {
+                    s.right[*it]--;
+                    s.left[*it]++;
+                }
+                swap(*l, *r);
+                swaps++;
+            }
+            if (!swaps) break;
+        }
+
+        count(first, mid, s.left, -1);
+        count(mid, last, s.right, -1);
+    }
+
+    void recurse(Scratch& s, E *first, E *last, unsigned spare)
+    {
+        if (static_cast<uint64_t>(last - first) <= leafSize) return;
+
+        split(s, first, last);
+        E *mid = first + (last - first) / 2;
+
+        if (spare) {
+            thread right([=]() { recurseLocal(mid, last, spare / 2); });
+            recurse(s, first, mid, spare / 2);
+            right.join();
+        } else {
+            recurse(s, first, mid, 0);
+            recurse(s, mid, last, 0);
+        }
+    }
+
+    // Like recurse, but first renumbers the vertices in [first, last) and
+    // their neighbours densely, so the scratch space of the thread running
+    // it is proportional to the subrange rather than the whole graph.
+    void recurseLocal(E *first, E *last, unsigned spare)
+    {
+        uint64_t n = static_cast<uint64_t>(last - first);
+
+        vector<E> ids;
+        for (E *v = first; v != last; ++v) {
+            ids.insert(ids.end(), adj.begin(*v), adj.end(*v));
+        }
+        sort(ids.begin(), ids.end());
+        ids.erase(unique(ids.begin(), ids.end()), ids.end());
+
+        Neighbours<E> local;
+        local.offsets.assign(n + 1, 0);
+        for (uint64_t i = 0; i < n; i++) {
+            for (auto it = adj.begin(first[i]); it != adj.end(first[i]); ++it) {
+                auto id = lower_bound(ids.begin(), ids.end(), *it);
+                local.edges.push_back(static_cast<E>(id - ids.begin()));
+            }
+            local.offsets[i + 1] = local.edges.size();
+        }
+
+        vector<E> order(n);
+        for (uint64_t i = 0; i < n; i++) order[i] = static_cast<E>(i);
+
+        Bisection sub(local, ids.size(), logs);
+        Scratch own(ids.size());
+        sub.recurse(own, order.data(), order.data() + n, spare);
+
+        vector<E> original(first, last);
+        for (uint64_t i = 0; i < n; i++) first[i] = original[order[i]];
+    }
+
+    Bisection
+    (const Neighbours<E>& neighbours, uint64_t count, const vector<double>& l)
+    : adj(neighbours), neighbourCount(count), logs(l)
+    {}
+
+  public:
+    Bisection(const Neighbours<E>& neighbours)
+    : adj(neighbours), neighbourCount(neighbours.size())
+    {
+        uint64_t maxDegree = 0;
+        for (uint64_t v = 0; v < adj.size(); v++) {
+            maxDegree = max(maxDegree, adj.degree(v));
+        }
+
+        logs.resize(maxDegree + 3);
+        for (uint64_t i = 1; i < logs.size(); i++) {
+            logs[i] = log2(static_cast<double>(i));
+        }
+    }
+
+    vector<E> operator()()
+    {
+        auto result = bfsOrder(adj, false);
+        Scratch s(neighbourCount);
+        unsigned spare = max(1U, thread::hardware_concurrency()) - 1;
+        recurse(s, result.data(), result.data() + result.size(), spare);
+        return result;
+    }
+};
+
+template<typename V, typename E>
+static void
+writeReordered
+( Graph<V,E>& graph, const string& fileName, const vector<E>& newOrder
+, size_t memoryBudget)
+{
     uint64_t updatedCount = 0;
-    vector<uint64_t> revLookup(newOrder.size());
+    vector<E> revLookup(newOrder.size());
 
     for (uint64_t i = 0; i < newOrder.size(); i++) {
-        revLookup.at(newOrder.at(i).vertexId) = i;
+        revLookup.at(newOrder.at(i)) = static_cast<E>(i);
         updatedCount++;
     }
 
-    assert(updatedCount == newOrder.size());
-    newOrder.clear();
+    assert(updatedCount == graph.vertex_count);
 
-    vector<Edge<uint64_t>> edges, rev_edges;
-    edges.reserve(graph.edge_count);
+    GraphBuilder<V,E> builder
+        (fileName, graph.undirected, memoryBudget);
+    relabelEdges(builder, revLookup, graph.raw_vertices, graph.raw_edges);
+    builder.write(fileName);
+}
 
-    for (auto &&edge : graph.edges) {
-        edges.emplace_back(revLookup.at(edge.in), revLookup.at(edge.out));
-    }
+static const vector<string> degreeOrders = {
+    "in", "out", "abs", "in-worst", "out-worst", "abs-worst"
+};
 
-    if (!graph.undirected) {
-        rev_edges.reserve(graph.edge_count);
+static const vector<string> localityOrders = {
+    "bfs", "rcm", "hub", "gorder", "bisect"
+};
 
-        for (auto &&edge : graph.rev_edges) {
-            rev_edges.emplace_back(revLookup.at(edge.in), revLookup.at(edge.out));
+template<typename V, typename E>
+static void
+reorderGraph
+( Graph<V,E>& graph, const string& baseName, const vector<string>& orders
+, size_t memoryBudget)
+{
+    unique_ptr<Neighbours<E>> adj;
+
+    for (auto& order : orders) {
+        vector<E> newOrder;
+        bool worst = order.find("-worst") != string::npos;
+
+        if (!order.compare(0, 2, "in")) {
+            newOrder = degreeOrder(graph, in_degree, worst);
+        } else if (!order.compare(0, 3, "out")) {
+            newOrder = degreeOrder(graph, out_degree, worst);
+        } else if (!order.compare(0, 3, "abs")) {
+            newOrder = degreeOrder(graph, abs_degree, worst);
+        } else {
+            if (!adj) adj.reset(new Neighbours<E>(graph));
+
+            if (order == "bfs") newOrder = bfsOrder(*adj, false);
+            else if (order == "rcm") newOrder = bfsOrder(*adj, true);
+            else if (order == "hub") newOrder = hubOrder(*adj);
+            else if (order == "gorder") newOrder = gOrder(*adj, 5);
+            else if (order == "bisect") newOrder = Bisection<E>(*adj)();
         }
-    }
 
-    Graph<uint64_t,uint64_t>::output(fileName, edges, rev_edges);
+        writeReordered(graph, baseName + "." + order + ".graph", newOrder,
+                       memoryBudget);
+    }
 }
 
 static void __attribute__((noreturn))
@@ -132,26 +626,77 @@ usage(int exitCode = EXIT_FAILURE)
 {
     ostream& out(exitCode == EXIT_SUCCESS ? cout : cerr);
     out << "Usage:" << endl;
-    out << execName << " <graph 1> [<graph 2>...]" << endl;
+    out << execName << " [--help | -h] [--memory MB | -m MB] "
+        << "[--order ORDER | -o ORDER]... <graph 1> [<graph 2>...]" << endl;
+    out << endl << "Orderings (default: all degree orderings):" << endl;
+    for (auto& order : degreeOrders) out << "    " << order << endl;
+    for (auto& order : localityOrders) out << "    " << order << endl;
     exit(exitCode);
 }
 
 int main(int argc, char **argv)
 {
     string name;
+    size_t memoryBudget = 4096;
+    vector<string> orders;
+
+    const char *optString = ":m:o:h?";
+    static const struct option longopts[] = {
+        { "memory", required_argument, nullptr, 'm' },
+        { "order", required_argument, nullptr, 'o' },
+        { "help", no_argument, nullptr, 'h' },
+        { nullptr, 0, nullptr, 0 },
+    };
+
+    for (;;) {
+        int longIndex;
+        int opt = getopt_long(argc, argv, optString, longopts, &longIndex);
+        if (opt == -1) break;
+
+        switch (opt) {
+            case 'm':
+                memoryBudget = stoul(optarg);
+                break;
+
+            case 'o': {
+                string order(optarg);
+                auto known = [&](const vector<string>& names) {
+                    return find(names.begin(), names.end(), order) != names.end();
+                };
+
+                if (!known(degreeOrders) && !known(localityOrders)) {
+                    cerr << "Unknown ordering: " << order << endl;
+                    usage();
+                }
+                orders.push_back(order);
+                break;
+            }
+
+            case 'h':
+            case '?':
+                usage(EXIT_SUCCESS);
+
+            case ':':
+                cerr << "Missing option for flag '" << optopt << "'." << endl;
+                FALLTHROUGH;
+            default:
+                usage();
+        }
+    }
+
+    argc -= optind;
+    argv = &argv[optind];
+    memoryBudget *= 1024 * 1024;
 
-    if (argc < 2) usage();
+    if (argc < 1) usage();
+    if (orders.empty()) orders = degreeOrders;
 
-    for (int i = 1; i < argc; i++) {
+    for (int i = 0; i < argc; i++) {
         name = string(argv[i]);
-        Graph<uint64_t, uint64_t> graph(name);
         string newName { name.substr(0, name.find_last_of(".")) };
-        sortGraph(graph, newName + ".in.graph", in_degree, false);
-        sortGraph(graph, newName + ".out.graph", out_degree, false);
-        sortGraph(graph, newName + ".abs.graph", abs_degree, false);
-        sortGraph(graph, newName + ".in-worst.graph", in_degree, true);
-        sortGraph(graph, newName + ".out-worst.graph", out_degree, true);
-        sortGraph(graph, newName + ".abs-worst.graph", abs_degree, true);
+        dispatch_graph(name, [&](auto& graph) {
+            reorderGraph(graph, newName, orders, memoryBudget);
+        });
     }
 
     return 0;
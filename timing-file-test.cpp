@@ -0,0 +1,82 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "Timer.hpp"
+#include "benchmark-analysis/cbits/timing-file.h"
+#include "utils/Util.hpp"
+
+// Serialises the result of the ingest C reader again, which has to be
+// identical to what Epoch::write_binary produced.
+static std::string
+serialise(const timing_file& file)
+{
+    std::string result("BLWTIMES", 8);
+    auto put = [&result](uint64_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; i++) {
+            result += static_cast<char>((value >> (8 * i)) & 0xff);
+        }
+    };
+
+    put(file.version, 4);
+    put(file.timer_count, 4);
+    for (uint32_t i = 0; i < file.timer_count; i++) {
+        auto& series = file.timers[i];
+        size_t length = strlen(series.name);
+
+        put(length, 4);
+        put(0, 4);
+        put(series.count, 8);
+        result.append(series.name, length);
+        put(0, (8 - length % 8) % 8);
+
+        for (uint64_t j = 0; j < series.count; j++) {
+            uint64_t bits;
+            memcpy(&bits, &series.samples[j], sizeof bits);
+            put(bits, 8);
+        }
+    }
+    return result;
+}
+
+int main()
+{
+    const std::string fileName = "timing-file-test.timings.bin";
+
+    {
+        Epoch epoch(fileName, false);
+        epoch.set_binary(true);
+
+        Timer total("computation", 4);
+        Timer step("0:bfsLevel", 4);
+        Timer aligned("aligned8", 4);
+        for (uint64_t i = 1; i <= 4; i++) {
+            total.add(1000 * i);
+            step.add(i);
+            aligned.start();
+            aligned.stop();
+        }
+    }
+
+    timing_file file;
+    checkError(!read_timing_file(fileName.c_str(), &file),
+               "Failed to read binary timings: ", fileName);
+
+    std::ifstream input(fileName, std::ios::binary);
+    std::string original{std::istreambuf_iterator<char>(input), {}};
+
+    checkError(file.timer_count == 3, "Expected 3 timers, found ",
+               file.timer_count);
+    for (uint32_t i = 0; i < file.timer_count; i++) {
+        checkError(file.timers[i].count == 4, "Expected 4 samples for ",
+                   file.timers[i].name, ", found ", file.timers[i].count);
+    }
+    checkError(serialise(file) == original,
+               "Binary timings don't round-trip through the C reader!");
+
+    free_timing_file(&file);
+    std::remove(fileName.c_str());
+    return 0;
+}
@@ -0,0 +1,129 @@
+#ifndef DEGREEPROPERTIES_HPP
+#define DEGREEPROPERTIES_HPP
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "StatisticalSummary.hpp"
+#include "Util.hpp"
+
+enum class Degrees { in, out, abs };
+
+// Degree distributions of a graph, as (degree, vertex count) pairs in
+// ascending degree order for each of Degrees. Computing them requires a pass
+// over all vertices, so they can be cached as "<graph>.props" in a cache
+// directory. The cache is only trusted while the graph's size and
+// modification time match.
+struct DegreeProperties {
+    typedef std::vector<std::pair<uint64_t,uint64_t>> Histogram;
+
+    uint64_t vertex_count = 0, edge_count = 0;
+    std::array<Histogram,3> histograms;
+
+    Histogram& histogram(Degrees d)
+    { return histograms[static_cast<size_t>(d)]; }
+
+    const Histogram& histogram(Degrees d) const
+    { return histograms[static_cast<size_t>(d)]; }
+
+    StatisticalSummary<double> summary(Degrees d) const
+    { return StatisticalSummary<double>::fromHistogram(histogram(d)); }
+
+    // Returns false if there's no valid cache for the graph.
+    bool load(const std::string& graphFile, const std::string& cacheDir)
+    {
+        uint64_t key[3];
+        if (!cacheKey(graphFile, key)) return false;
+
+        std::ifstream input(cacheFile(graphFile, cacheDir), std::ios::binary);
+        uint64_t header[6];
+        if (!read(input, header, 6)) return false;
+        if (header[0] != magic || header[1] != key[0] || header[2] != key[1]
+            || header[3] != key[2]) {
+            return false;
+        }
+
+        vertex_count = header[4];
+        edge_count = header[5];
+        for (auto& hist : histograms) {
+            uint64_t size;
+            if (!read(input, &size, 1)) return false;
+            hist.assign(size, {0, 0});
+            if (!read(input, hist.data(), size)) return false;
+        }
+        return true;
+    }
+
+    // Best effort, the cache directory may not be writable.
+    void save(const std::string& graphFile, const std::string& cacheDir) const
+    {
+        uint64_t key[3];
+        if (!cacheKey(graphFile, key)) return;
+
+        std::string file = cacheFile(graphFile, cacheDir);
+        std::string tmpFile = file + "." + std::to_string(getpid());
+        {
+            std::ofstream output(tmpFile, std::ios::binary);
+            uint64_t header[6] = { magic, key[0], key[1], key[2]
+                                 , vertex_count, edge_count };
+            write(output, header, 6);
+            for (auto& hist : histograms) {
+                uint64_t size = hist.size();
+                write(output, &size, 1);
+                write(output, hist.data(), size);
+            }
+            if (output.good()) output.close();
+            if (output.good()) {
+                std::rename(tmpFile.c_str(), file.c_str());
+                return;
+            }
+        }
+        std::remove(tmpFile.c_str());
+    }
+
+  private:
+    static constexpr uint64_t magic = 0x3250524f50474c42; // "BLGPROP2"
+
+    static std::string
+    cacheFile(const std::string& graphFile, const std::string& cacheDir)
+    {
+        auto slash = graphFile.find_last_of('/');
+        auto name = slash == std::string::npos ? graphFile
+                                               : graphFile.substr(slash + 1);
+        return cacheDir + "/" + name + ".props";
+    }
+
+    static bool cacheKey(const std::string& graphFile, uint64_t *key)
+    {
+        struct stat info;
+        if (stat(graphFile.c_str(), &info)) return false;
+        auto mtime = modification_time(info);
+        key[0] = static_cast<uint64_t>(info.st_size);
+        key[1] = static_cast<uint64_t>(mtime.tv_sec);
+        key[2] = static_cast<uint64_t>(mtime.tv_nsec);
+        return true;
+    }
+
+    template<typename T>
+    static bool read(std::ifstream& input, T *data, uint64_t count)
+    {
+        input.read(reinterpret_cast<char*>(data),
+                   static_cast<std::streamsize>(count * sizeof(T)));
+        return input.good();
+    }
+
+    template<typename T>
+    static void write(std::ofstream& output, const T *data, uint64_t count)
+    {
+        output.write(reinterpret_cast<const char*>(data),
+                     static_cast<std::streamsize>(count * sizeof(T)));
+    }
+};
+#endif
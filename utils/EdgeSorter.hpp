@@ -0,0 +1,319 @@
+#ifndef EDGESORTER_HPP
+#define EDGESORTER_HPP
+
+#include <cstdio>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Graph.hpp"
+#include "Util.hpp"
+
+// External-memory sort for edge lists that don't fit in RAM. Producers hand
+// over batches of edges with addRun, which sorts (and optionally
+// deduplicates) them. Sorted batches are kept in memory until they take up
+// half the budget, then they're merged into a single run on disk. finish()
+// merges the runs at most maxFanIn at a time, until the remaining runs can
+// be merged while iterating, and counts the edges. Iterating the
+// sorter k-way merges the remaining runs, yielding the edges in sorted
+// order, which makes it usable as an edge collection for
+// MutableGraph::outputSortedUniq.
+template<typename E>
+class EdgeSorter {
+    static constexpr size_t maxFanIn = 64;
+
+    struct Run {
+      std::string file;
+      std::vector<Edge<E>> edges;
+      uint64_t size;
+    };
+
+    class Reader {
+        std::ifstream input;
+        std::vector<Edge<E>> buffer;
+        const Edge<E> *data;
+        size_t offset, available, bufferEdges;
+        uint64_t remaining;
+
+      public:
+        Reader(const Run& run, size_t bufferSize)
+          : data(run.edges.data()), offset(0), available(run.edges.size())
+          , bufferEdges(bufferSize), remaining(0)
+        {
+          if (!run.file.empty()) {
+            input.open(run.file, std::ios::binary);
+            checkError(input.good(), "Failed to open edge run: ", run.file);
+            remaining = run.size;
+            fill();
+          }
+        }
+
+        bool done() const
+        { return offset >= available; }
+
+        const Edge<E>& peek() const
+        { return data[offset]; }
+
+        void next()
+        { if (++offset == available && remaining) fill(); }
+
+      private:
+        void fill()
+        {
+          size_t count = std::min<uint64_t>(remaining, bufferEdges);
+          buffer.assign(count, Edge<E>(0, 0));
+          input.read(reinterpret_cast<char*>(buffer.data()),
+                     static_cast<std::streamsize>(count * sizeof(Edge<E>)));
+          checkError(input.good(), "Failed to read edge run!");
+
+          data = buffer.data();
+          offset = 0;
+          available = count;
+          remaining -= count;
+        }
+    };
+
+    struct MergeState {
+      std::vector<std::unique_ptr<Reader>> readers;
+
+      struct Later {
+        const MergeState *state;
+        bool operator()(size_t a, size_t b) const
+        { return state->readers[b]->peek() < state->readers[a]->peek(); }
+      };
+
+      std::priority_queue<size_t, std::vector<size_t>, Later> heap;
+      bool dedup;
+      bool hasCurrent;
+      Edge<E> current;
+
+      template<typename It>
+      MergeState(It first, It last, bool uniq, size_t bufferEdges)
+        : heap(Later{this}), dedup(uniq), hasCurrent(false), current(0, 0)
+      {
+        for (; first != last; ++first) {
+          readers.emplace_back(new Reader(*first, bufferEdges));
+          if (!readers.back()->done()) heap.push(readers.size() - 1);
+        }
+        advance();
+      }
+
+      void advance()
+      {
+        while (!heap.empty()) {
+          size_t idx = heap.top();
+          heap.pop();
+
+          Edge<E> edge = readers[idx]->peek();
+          readers[idx]->next();
+          if (!readers[idx]->done()) heap.push(idx);
+
+          if (!dedup || !hasCurrent || edge != current) {
+            current = edge;
+            hasCurrent = true;
+            return;
+          }
+        }
+        hasCurrent = false;
+      }
+    };
+
+  public:
+    class iterator : public std::iterator<std::input_iterator_tag, Edge<E>> {
+        std::shared_ptr<MergeState> state;
+
+      public:
+        iterator() {}
+
+        iterator(std::shared_ptr<MergeState> s) : state(s)
+        { if (!state->hasCurrent) state.reset(); }
+
+        const Edge<E>& operator*() const
+        { return state->current; }
+
+        const Edge<E>* operator->() const
+        { return &state->current; }
+
+        iterator& operator++()
+        {
+          state->advance();
+          if (!state->hasCurrent) state.reset();
+          return *this;
+        }
+
+        bool operator==(const iterator& it) const
+        { return state == it.state; }
+
+        bool operator!=(const iterator& it) const
+        { return !operator==(it); }
+    };
+
+    EdgeSorter(const std::string& prefix, size_t memoryBudget, bool uniq = true)
+      : filePrefix(prefix), budget(memoryBudget), dedup(uniq), memoryUsed(0)
+      , runCount(0), finished(false), sorting(0)
+      , hardwareThreads(std::max(1U, std::thread::hardware_concurrency()))
+    {}
+
+    EdgeSorter(const EdgeSorter&) = delete;
+    void operator=(const EdgeSorter&) = delete;
+
+    ~EdgeSorter()
+    {
+      for (auto& run : runs) {
+        if (!run.file.empty()) std::remove(run.file.c_str());
+      }
+    }
+
+    // Thread-safe, sorting and deduplication happen outside the lock.
+    void addRun(std::vector<Edge<E>>&& edges)
+    {
+      if (edges.empty()) return;
+
+      // Concurrent producers split the hardware threads between them.
+      size_t active = ++sorting;
+      radix_sort_edges(edges, 0, dedup, std::max<size_t>(1, hardwareThreads / active));
+      --sorting;
+
+      Run run{std::string(), std::move(edges), 0};
+      run.size = run.edges.size();
+      size_t bytes = run.size * sizeof(Edge<E>);
+
+      std::lock_guard<std::mutex> guard(lock);
+      checkError(!finished, "Adding edges to a finished EdgeSorter!");
+
+      if (memoryUsed && memoryUsed + bytes > budget / 2) spillMemory();
+
+      memoryUsed += bytes;
+      runs.emplace_back(std::move(run));
+    }
+
+    // Merges runs until iteration needs at most maxFanIn of them and the
+    // edge count is known. Called by count(), producers must be done.
+    void finish()
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      if (finished) return;
+      finished = true;
+
+      size_t files = 0;
+      for (auto& run : runs) files += !run.file.empty();
+
+      if (files && memoryUsed) spillMemory();
+
+      while (runs.size() > maxFanIn) {
+        size_t fanIn = std::min(maxFanIn, runs.size());
+        Run run = mergeToFile(runs.begin(), runs.begin() + fanIn);
+        runs.erase(runs.begin(), runs.begin() + fanIn);
+        runs.emplace_back(std::move(run));
+      }
+
+      // Without dedup the count is the sum of the run sizes, otherwise the
+      // duplicates between runs are counted by a read-only merge.
+      edgeCount = 0;
+      if (dedup && runs.size() > 1) {
+        merge(runs.begin(), runs.end(), [this](const Edge<E>&) {
+            edgeCount++;
+        });
+      } else {
+        for (auto& run : runs) edgeCount += run.size;
+      }
+    }
+
+    // Iterating requires finish() when runs were spilled to disk.
+    iterator begin() const
+    {
+      checkError(runs.size() <= maxFanIn, "Iterating an unfinished EdgeSorter!");
+      return iterator(std::make_shared<MergeState>(runs.begin(), runs.end(),
+                                                   dedup, bufferEdges()));
+    }
+
+    iterator end() const
+    { return iterator(); }
+
+    bool empty() const
+    { return runs.empty(); }
+
+    // Number of edges yielded by iteration.
+    uint64_t count()
+    {
+      finish();
+      return edgeCount;
+    }
+
+  private:
+    size_t bufferEdges() const
+    {
+      return std::clamp<size_t>(budget / ((maxFanIn + 1) * sizeof(Edge<E>)),
+                                1 << 10, 1 << 16);
+    }
+
+    template<typename It, typename F>
+    void merge(It first, It last, F&& output) const
+    {
+      MergeState state(first, last, dedup, bufferEdges());
+      for (; state.hasCurrent; state.advance()) output(state.current);
+    }
+
+    template<typename It>
+    Run mergeToFile(It first, It last)
+    {
+      Run result{filePrefix + ".run" + std::to_string(runCount++), {}, 0};
+      std::ofstream output(result.file, std::ios::binary);
+
+      std::vector<Edge<E>> buffer;
+      buffer.reserve(bufferEdges());
+      auto flush = [&]() {
+          output.write(reinterpret_cast<const char*>(buffer.data()),
+                       static_cast<std::streamsize>(buffer.size()
+                                                    * sizeof(Edge<E>)));
+          result.size += buffer.size();
+          buffer.clear();
+      };
+
+      merge(first, last, [&](const Edge<E>& edge) {
+          buffer.push_back(edge);
+          if (buffer.size() == buffer.capacity()) flush();
+      });
+      flush();
+      checkError(output.good(), "Failed to write edge run: ", result.file);
+
+      for (auto it = first; it != last; ++it) {
+        if (!it->file.empty()) std::remove(it->file.c_str());
+        it->file.clear();
+      }
+      return result;
+    }
+
+    // Merges the runs held in memory into a single run on disk.
+    void spillMemory()
+    {
+      auto mem = std::stable_partition(runs.begin(), runs.end(),
+          [](const Run& run) { return !run.file.empty(); });
+
+      Run run = mergeToFile(mem, runs.end());
+      runs.erase(mem, runs.end());
+      runs.emplace_back(std::move(run));
+      memoryUsed = 0;
+    }
+
+    const std::string filePrefix;
+    const size_t budget;
+    const bool dedup;
+
+    std::mutex lock;
+    std::vector<Run> runs;
+    size_t memoryUsed;
+    size_t runCount;
+    bool finished;
+    uint64_t edgeCount;
+    std::atomic<size_t> sorting;
+    const size_t hardwareThreads;
+};
+#endif
@@ -8,16 +8,21 @@
 
 #include <cassert>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
 #include <limits>
+#include <mutex>
 #include <random>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include "DegreeProperties.hpp"
 #include "Util.hpp"
-#include "StatisticalSummary.hpp"
-
-enum class Degrees { in, out, abs };
 
 template<typename E>
 struct Edge {
@@ -57,79 +62,334 @@ Edge<E> triangular_edge(uint64_t idx)
     return Edge<E>(row, col);
 }
 
-template<typename E>
-std::vector<Edge<E>>
-random_edges(bool undirected, uint64_t vertex_count, uint64_t edge_count);
+template<typename F>
+void parallel_blocks(uint64_t count, F&& f, size_t threads = 0);
+
+// Calls f(i) for every i in [0, count) on the given number of threads (0
+// means all hardware threads), handing out indices dynamically to balance
+// uneven blocks. Workers aren't bound by the caller's CPU pinning.
+template<typename F>
+void parallel_blocks(uint64_t count, F&& f, size_t threads)
+{
+    std::atomic<uint64_t> next(0);
+    auto worker = [&]() {
+        for (uint64_t i; (i = next++) < count;) f(i);
+    };
+
+    if (threads == 0) threads = std::max(1U, std::thread::hardware_concurrency());
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threads && i < count; i++) {
+        workers.push_back(unpinned_thread(worker));
+    }
+    worker();
+    for (auto& t : workers) t.join();
+}
 
 template<typename E>
-std::vector<Edge<E>>
-random_edges(bool undirected, uint64_t vertex_count, uint64_t edge_count)
+void radix_sort_edges
+    ( std::vector<Edge<E>>& edges, uint64_t vertex_count = 0
+    , bool uniq = false, size_t threads = 0);
+
+// Parallel LSD radix sort on the (in, out) key, only sorting as many 11-bit
+// digits as vertex ids below vertex_count need (0 means look up the largest
+// id). Passes where all edges share a digit are skipped. Duplicates are
+// dropped while compacting the result, when requested. Uses the given number
+// of threads (0 means all hardware threads), small inputs just use
+// std::sort.
+template<typename E>
+void radix_sort_edges
+    (std::vector<Edge<E>>& edges, uint64_t vertex_count, bool uniq, size_t threads)
 {
-    std::mt19937_64 generator{std::random_device()()};
-    std::vector<Edge<E>> edges;
-    uint64_t max_edges;
+    constexpr int digitBits = 11;
+    constexpr size_t radix = 1 << digitBits;
+    constexpr size_t smallSort = 1 << 16;
+
+    if (edges.size() < smallSort) {
+        std::sort(edges.begin(), edges.end());
+        if (uniq) edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+        return;
+    }
 
-    if (undirected) max_edges = (vertex_count * (vertex_count + 1))/2;
-    else max_edges = vertex_count * vertex_count;
+    uint64_t n = edges.size();
+    if (threads == 0) threads = std::max(1U, std::thread::hardware_concurrency());
+    uint64_t chunks = threads;
+    auto first = [&](uint64_t c) { return n / chunks * c + std::min(c, n % chunks); };
+
+    if (vertex_count == 0) {
+        std::vector<uint64_t> maxima(chunks, 0);
+        parallel_blocks(chunks, [&](uint64_t c) {
+            for (uint64_t i = first(c); i < first(c + 1); i++) {
+                maxima[c] = std::max<uint64_t>(maxima[c],
+                                std::max(edges[i].in, edges[i].out));
+            }
+        }, threads);
+        vertex_count = *std::max_element(maxima.begin(), maxima.end()) + 1;
+    }
 
-    edges.reserve(undirected ? 2*edge_count : edge_count);
+    int digits = 0;
+    while (digitBits * digits < 64 && (vertex_count - 1) >> (digitBits * digits)) digits++;
+
+    std::vector<Edge<E>> buffer(n, Edge<E>(0, 0));
+    Edge<E> *src = edges.data(), *dst = buffer.data();
+    std::vector<uint64_t> counts(chunks * radix);
+
+    for (int pass = 0; pass < 2 * digits; pass++) {
+        bool outgoing = pass < digits;
+        int shift = digitBits * (outgoing ? pass : pass - digits);
+        auto digit = [=](const Edge<E>& e) {
+            return static_cast<size_t>(((outgoing ? e.out : e.in) >> shift) & (radix - 1));
+        };
+
+        parallel_blocks(chunks, [&](uint64_t c) {
+            uint64_t *hist = &counts[c * radix];
+            std::fill(hist, hist + radix, 0);
+            for (uint64_t i = first(c); i < first(c + 1); i++) {
+                hist[digit(src[i])]++;
+            }
+        }, threads);
+
+        uint64_t total = 0;
+        bool trivial = false;
+        for (size_t d = 0; d < radix; d++) {
+            uint64_t start = total;
+            for (uint64_t c = 0; c < chunks; c++) {
+                total += std::exchange(counts[c * radix + d], total);
+            }
+            if (total - start == n) trivial = true;
+        }
 
-    for (uint64_t i = 0; i < edge_count; i++) {
-        if (undirected) edges.emplace_back(triangular_edge<E>(i));
-        else edges.emplace_back(i / vertex_count, i % vertex_count);
+        if (trivial) continue;
+
+        parallel_blocks(chunks, [&](uint64_t c) {
+            uint64_t *offsets = &counts[c * radix];
+            for (uint64_t i = first(c); i < first(c + 1); i++) {
+                dst[offsets[digit(src[i])]++] = src[i];
+            }
+        }, threads);
+
+        std::swap(src, dst);
     }
 
-    {
-        std::unordered_map<uint64_t, Edge<E>> sparse_array;
-        sparse_array.reserve(edge_count);
+    if (uniq) {
+        std::vector<uint64_t> kept(chunks + 1, 0);
+        auto isNew = [&](uint64_t i) { return i == 0 || src[i] != src[i - 1]; };
 
-        for (uint64_t i = 0; i < edge_count; i++) {
-            std::uniform_int_distribution<uint64_t> new_edge(i, max_edges - 1);
-            uint64_t idx = new_edge(generator);
+        parallel_blocks(chunks, [&](uint64_t c) {
+            for (uint64_t i = first(c); i < first(c + 1); i++) kept[c] += isNew(i);
+        }, threads);
 
-            if (idx < edge_count) {
-                std::swap(edges[i], edges[idx]);
-            } else {
-                Edge<E> edge(0,0);
-                if (undirected) edge = triangular_edge<E>(idx);
-                else edge = Edge<E>(idx / vertex_count, idx % vertex_count);
+        uint64_t total = 0;
+        for (auto& count : kept) total += std::exchange(count, total);
 
-                std::swap(edges[i], sparse_array.emplace(idx, edge).first->second);
+        parallel_blocks(chunks, [&](uint64_t c) {
+            uint64_t out = kept[c];
+            for (uint64_t i = first(c); i < first(c + 1); i++) {
+                if (isNew(i)) dst[out++] = src[i];
             }
-        }
+        }, threads);
+
+        n = total;
+        std::swap(src, dst);
     }
 
-    if (undirected) {
-        uint64_t size = edges.size();
-        for (uint64_t i = 0; i < size; i++) {
-            Edge<E> e = edges[i];
-            if (e.in != e.out) edges.emplace_back(e.out, e.in);
+    if (src != edges.data()) edges.swap(buffer);
+    edges.resize(n, Edge<E>(0, 0));
+}
+
+// Streaming uniform random graph generator. The space of possible edges (the
+// lower triangle including the diagonal for undirected graphs, all vertex
+// pairs otherwise) is split into blocks, each sampled with geometric skips
+// from its own RNG stream. Blocks are generated in parallel and each block's
+// edges are handed to sink(block, edges) in sorted order (for undirected
+// graphs the mirrored edges follow), so the edge set never has to be held in
+// memory. sink may be called concurrently from multiple threads.
+template<typename E>
+class RandomEdges {
+    static constexpr uint64_t blockEdges = 1 << 20;
+
+    const bool undirected;
+    const uint64_t vertex_count;
+    const uint64_t max_edges;
+    const uint64_t seed;
+
+    struct Block {
+      uint64_t first, last;
+    };
+
+    std::vector<Block> blocks(double expected) const
+    {
+      size_t threads = std::max(1U, std::thread::hardware_concurrency());
+      uint64_t count = std::max<uint64_t>(4 * threads,
+              static_cast<uint64_t>(expected / blockEdges) + 1);
+      count = std::max<uint64_t>(1, std::min(count, max_edges));
+
+      std::vector<Block> result;
+      for (uint64_t b = 0; b < count; b++) {
+        result.push_back({ max_edges / count * b + std::min(b, max_edges % count)
+                         , max_edges / count * (b + 1)
+                           + std::min(b + 1, max_edges % count) });
+      }
+      return result;
+    }
+
+    // Calls f(edge) for each candidate pair index selected in the block
+    // with probability p, deterministically for a given round.
+    template<typename F>
+    void sampleBlock(const Block& block, uint64_t b, uint64_t round, double p, F&& f) const
+    {
+      std::seed_seq seq{seed, seed >> 32, b, round};
+      std::mt19937_64 generator(seq);
+      // Unused when p >= 1, every candidate is selected then.
+      std::geometric_distribution<uint64_t> skip(p < 1.0 ? p : 0.5);
+
+      uint64_t row, col;
+      if (undirected) {
+        row = triangular_edge<uint64_t>(block.first).in;
+        while (row * (row + 1) / 2 > block.first) row--;
+        while ((row + 1) * (row + 2) / 2 <= block.first) row++;
+        col = block.first - row * (row + 1) / 2;
+      } else {
+        row = block.first / vertex_count;
+        col = block.first % vertex_count;
+      }
+
+      uint64_t idx = block.first;
+      while (true) {
+        uint64_t gap = p >= 1.0 ? 0 : skip(generator);
+        if (gap >= block.last - idx) break;
+        idx += gap;
+
+        for (col += gap;;) {
+          uint64_t length = undirected ? row + 1 : vertex_count;
+          if (col < length) break;
+          col -= length;
+          row++;
         }
+
+        f(Edge<E>(static_cast<E>(row), static_cast<E>(col)));
+
+        if (++idx == block.last) break;
+        col++;
+      }
     }
 
-    std::sort(edges.begin(), edges.end());
+    template<typename Keep, typename F>
+    void emit(const std::vector<Block>& parts, uint64_t round, double p,
+              Keep&& keep, F&& sink) const
+    {
+      parallel_blocks(parts.size(), [&](uint64_t b) {
+        std::vector<Edge<E>> edges, mirrored;
+        uint64_t local = 0;
+
+        sampleBlock(parts[b], b, round, p, [&](const Edge<E>& edge) {
+          if (!keep(b, local++)) return;
+          edges.push_back(edge);
+          if (undirected && edge.in != edge.out) {
+            mirrored.emplace_back(edge.out, edge.in);
+          }
+        });
+
+        edges.insert(edges.end(), mirrored.begin(), mirrored.end());
+        sink(b, std::move(edges));
+      });
+    }
 
-    return edges;
-}
+  public:
+    RandomEdges(bool undirected_, uint64_t vertices)
+      : undirected(undirected_), vertex_count(vertices)
+      , max_edges(undirected ? (vertices * (vertices + 1)) / 2
+                             : vertices * vertices)
+      , seed(std::random_device()() ^ (uint64_t(std::random_device()()) << 32))
+    {}
 
-template<typename E>
+    uint64_t maxEdges() const
+    { return max_edges; }
+
+    // Every possible edge is included independently with probability p.
+    template<typename F>
+    void sample(double p, F&& sink) const
+    {
+      if (max_edges == 0 || p <= 0) return;
+      auto parts = blocks(p * static_cast<double>(max_edges));
+      emit(parts, 0, p, [](uint64_t, uint64_t) { return true; }, sink);
+    }
+
+    // Exactly edge_count distinct edges, uniformly at random. Candidates are
+    // oversampled with geometric skips, counted per block, and a uniformly
+    // random surplus is dropped while regenerating them.
+    template<typename F>
+    void sample(uint64_t edge_count, F&& sink) const
+    {
+      checkError(edge_count <= max_edges, "Requested more edges than ",
+                 "possible! Edge count: ", edge_count, " Max: ", max_edges);
+      if (edge_count == 0) return;
+
+      double m = static_cast<double>(edge_count);
+      double p = (m + 3 * std::sqrt(m) + 16) / static_cast<double>(max_edges);
+      auto parts = blocks(m);
+
+      uint64_t round = 0;
+      std::vector<uint64_t> counts(parts.size());
+      for (;; round++, p *= 1.1) {
+        parallel_blocks(parts.size(), [&](uint64_t b) {
+          counts[b] = 0;
+          sampleBlock(parts[b], b, round, p, [&](const Edge<E>&) { counts[b]++; });
+        });
+
+        uint64_t total = 0;
+        for (auto& count : counts) total += std::exchange(count, total);
+        if (total >= edge_count) {
+          counts.push_back(total);
+          break;
+        }
+      }
+
+      uint64_t total = counts.back();
+      std::mt19937_64 generator(seed ^ round);
+      std::unordered_set<uint64_t> dropSet;
+      for (uint64_t j = edge_count; j < total; j++) {
+        uint64_t t = std::uniform_int_distribution<uint64_t>(0, j)(generator);
+        if (!dropSet.insert(t).second) dropSet.insert(j);
+      }
+
+      std::vector<uint64_t> drops(dropSet.begin(), dropSet.end());
+      std::sort(drops.begin(), drops.end());
+
+      emit(parts, round, p, [&](uint64_t b, uint64_t local) {
+        uint64_t idx = counts[b] + local;
+        return !std::binary_search(drops.begin(), drops.end(), idx);
+      }, sink);
+    }
+};
+
+template<typename E, typename N>
 std::vector<Edge<E>>
-random_edges(bool undirected, uint64_t vertex_count, double mutation_rate);
+random_edges(bool undirected, uint64_t vertex_count, N count);
 
-template<typename E>
+// Collects the output of RandomEdges into a single sorted vector, count is
+// either an exact edge count or an edge probability.
+template<typename E, typename N>
 std::vector<Edge<E>>
-random_edges(bool undirected, uint64_t vertex_count, double mutation_rate)
+random_edges(bool undirected, uint64_t vertex_count, N count)
 {
-    std::mt19937_64 generator{std::random_device()()};
-    uint64_t max_edges;
+    std::vector<std::vector<Edge<E>>> blocks;
+    std::mutex lock;
 
-    if (undirected) max_edges = (vertex_count * (vertex_count + 1))/2;
-    else max_edges = vertex_count * vertex_count;
+    RandomEdges<E>(undirected, vertex_count).sample(count,
+        [&](uint64_t b, std::vector<Edge<E>>&& edges) {
+            std::lock_guard<std::mutex> guard(lock);
+            if (b >= blocks.size()) blocks.resize(b + 1);
+            blocks[b] = std::move(edges);
+        });
 
-    std::binomial_distribution<uint64_t> num_muts(max_edges, mutation_rate);
-    uint64_t mutation_count = num_muts(generator);
+    std::vector<Edge<E>> edges;
+    for (auto& block : blocks) {
+        edges.insert(edges.end(), block.begin(), block.end());
+        std::vector<Edge<E>>().swap(block);
+    }
 
-    return random_edges<E>(undirected, vertex_count, mutation_count);
+    if (undirected) radix_sort_edges(edges, vertex_count);
+    return edges;
 }
 
 template<typename E>
@@ -147,7 +407,7 @@ reverse_and_sort(const std::vector<Edge<E>>& edges)
         result.emplace_back(e.out, e.in);
     }
 
-    std::sort(result.begin(), result.end());
+    radix_sort_edges(result);
 
     return result;
 }
@@ -386,6 +646,47 @@ class Accessor {
       return value;
     }
 
+    // Raw contiguous view of the data, U has to match the on-disk width.
+    template<typename U>
+    U* span()
+    {
+      checkError(sizeof(U) == valueSize, "Accessor width mismatch! ",
+          "Requested: ", sizeof(U), " Stored: ", valueSize);
+      return static_cast<U*>(data);
+    }
+
+    template<typename U>
+    const U* span() const
+    {
+      checkError(sizeof(U) == valueSize, "Accessor width mismatch! ",
+          "Requested: ", sizeof(U), " Stored: ", valueSize);
+      return static_cast<const U*>(data);
+    }
+
+    // Handle on the underlying storage that keeps the file mapping alive,
+    // allowing the data to be shared without copying.
+    std::shared_ptr<void> storage() const
+    { return data; }
+
+    // Dispatches on the on-disk width once and calls f with a raw pointer to
+    // the data, avoiding the per-element checks of operator[]. Version 0 files
+    // store non-negative int32_t, so they're handed out as uint32_t.
+    template<typename F>
+    decltype(auto) visit(F&& f) const
+    {
+      if (valueSize == 4) return f(span<uint32_t>());
+      else if (valueSize == 8) return f(span<uint64_t>());
+      reportError("Invalid graph file version or vertex/edge size!");
+    }
+
+    template<typename F>
+    decltype(auto) visit(F&& f)
+    {
+      if (valueSize == 4) return f(span<uint32_t>());
+      else if (valueSize == 8) return f(span<uint64_t>());
+      reportError("Invalid graph file version or vertex/edge size!");
+    }
+
     iterator begin() { return iterator(*this, false); }
     const_iterator begin() const { return const_iterator(*this, false); }
     const_iterator cbegin() const { return const_iterator(*this, false); }
@@ -865,6 +1166,279 @@ class MutableGraph {
       return shared_array<uint32_t>(ptr, deleter);
     }
 
+    // Version 2 files store each adjacency list as a varint degree followed
+    // by zigzag varint deltas (the first relative to the vertex id). Vertices
+    // are grouped in blocks, a sparse index records the byte and edge offset
+    // of each block so blocks can be decoded in parallel. Loading decodes
+    // into an in-memory version 1 layout, so the rest of the API is unchanged.
+    static constexpr uint64_t compressedBlock = 256;
+    static constexpr size_t compressedHeader = 8 * sizeof(uint64_t);
+
+    struct BlockIndex {
+      uint64_t byteOffset;
+      uint64_t edgeOffset;
+    };
+
+    static size_t varintSize(uint64_t val)
+    {
+      size_t result = 1;
+      for (; val >= 0x80; val >>= 7) result++;
+      return result;
+    }
+
+    static uint8_t* putVarint(uint8_t *ptr, uint64_t val)
+    {
+      for (; val >= 0x80; val >>= 7) *ptr++ = static_cast<uint8_t>(val | 0x80);
+      *ptr++ = static_cast<uint8_t>(val);
+      return ptr;
+    }
+
+    static const uint8_t*
+    getVarint(const uint8_t *ptr, const uint8_t *end, uint64_t& val)
+    {
+      uint64_t result = 0;
+      for (unsigned shift = 0; shift < 64; shift += 7) {
+        checkError(ptr < end, "Corrupt compressed graph!");
+        uint8_t byte = *ptr++;
+        result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) break;
+      }
+      val = result;
+      return ptr;
+    }
+
+    static uint64_t zigzag(uint64_t from, uint64_t to)
+    {
+      int64_t delta = static_cast<int64_t>(to - from);
+      return (static_cast<uint64_t>(delta) << 1)
+           ^ static_cast<uint64_t>(delta >> 63);
+    }
+
+    static uint64_t unzigzag(uint64_t from, uint64_t val)
+    { return from + ((val >> 1) ^ (~(val & 1) + 1)); }
+
+    template<typename F>
+    static void withWidth(void *ptr, uint32_t width, F&& f)
+    {
+      if (width == 4) f(static_cast<uint32_t*>(ptr));
+      else if (width == 8) f(static_cast<uint64_t*>(ptr));
+      else reportError("Invalid graph file version or vertex/edge size!");
+    }
+
+    // Calls emit for every varint of the vertices in [first, last).
+    template<typename VT, typename ET, typename F>
+    static void encodeVertices
+    (const VT *vertices, const ET *edges, uint64_t first, uint64_t last, F&& emit)
+    {
+      for (uint64_t v = first; v < last; v++) {
+        uint64_t prev = v;
+        emit(vertices[v + 1] - vertices[v]);
+        for (uint64_t i = vertices[v]; i < vertices[v + 1]; i++) {
+          emit(zigzag(prev, edges[i]));
+          prev = edges[i];
+        }
+      }
+    }
+
+    // Fills in the block index and returns the (8 byte aligned) payload size.
+    static uint64_t
+    indexSection
+    ( const Accessor<V>& raw_verts, const Accessor<E>& raw_edgs
+    , uint64_t vertex_count, std::vector<BlockIndex>& index)
+    {
+      uint64_t blocks = index.size() - 1;
+
+      raw_verts.visit([&](auto vertices) {
+        raw_edgs.visit([&](auto edges) {
+          parallel_blocks(blocks, [&](uint64_t b) {
+            uint64_t first = b * compressedBlock;
+            uint64_t last = std::min(vertex_count, first + compressedBlock);
+            uint64_t bytes = 0;
+
+            encodeVertices(vertices, edges, first, last,
+                           [&](uint64_t val) { bytes += varintSize(val); });
+
+            index[b + 1].byteOffset = bytes;
+            index[b + 1].edgeOffset = vertices[last] - vertices[first];
+          });
+        });
+      });
+
+      index[0] = {0, 0};
+      for (uint64_t b = 1; b <= blocks; b++) {
+        index[b].byteOffset += index[b - 1].byteOffset;
+        index[b].edgeOffset += index[b - 1].edgeOffset;
+      }
+
+      return (index[blocks].byteOffset + 7) & ~uint64_t(7);
+    }
+
+    static void
+    encodeSection
+    ( const Accessor<V>& raw_verts, const Accessor<E>& raw_edgs
+    , uint64_t vertex_count, const std::vector<BlockIndex>& index
+    , uint8_t *out)
+    {
+      uint64_t blocks = index.size() - 1;
+      std::copy(index.begin(), index.end(), reinterpret_cast<BlockIndex*>(out));
+      out += index.size() * sizeof(BlockIndex);
+
+      raw_verts.visit([&](auto vertices) {
+        raw_edgs.visit([&](auto edges) {
+          parallel_blocks(blocks, [&](uint64_t b) {
+            uint64_t first = b * compressedBlock;
+            uint64_t last = std::min(vertex_count, first + compressedBlock);
+            uint8_t *ptr = out + index[b].byteOffset;
+
+            encodeVertices(vertices, edges, first, last,
+                           [&](uint64_t val) { ptr = putVarint(ptr, val); });
+          });
+        });
+      });
+    }
+
+    static void
+    decodeSection
+    ( const uint8_t *section, uint64_t payload, uint64_t vertex_count
+    , uint64_t edge_count, uint64_t blockSize, void *vertexPtr
+    , uint32_t vertexWidth, void *edgePtr, uint32_t edgeWidth)
+    {
+      uint64_t blocks = (vertex_count + blockSize - 1) / blockSize;
+      auto index = reinterpret_cast<const BlockIndex*>(section);
+      auto bytes = section + (blocks + 1) * sizeof(BlockIndex);
+
+      checkError(index[0].byteOffset == 0 && index[0].edgeOffset == 0
+                && index[blocks].byteOffset <= payload
+                && index[blocks].edgeOffset == edge_count,
+                "Corrupt compressed graph!");
+
+      // Every vertex takes at least one byte for its degree and every edge at
+      // least one byte for its delta, so a valid index is monotone and each
+      // block spans enough bytes for its vertices and edges.
+      for (uint64_t b = 0; b < blocks; b++) {
+        uint64_t blockVertices = std::min(vertex_count - b * blockSize,
+                                          blockSize);
+        uint64_t blockEdges = index[b + 1].edgeOffset - index[b].edgeOffset;
+        uint64_t blockBytes = index[b + 1].byteOffset - index[b].byteOffset;
+
+        checkError(index[b].edgeOffset <= index[b + 1].edgeOffset
+                  && index[b].byteOffset <= index[b + 1].byteOffset
+                  && blockBytes >= blockVertices
+                  && blockBytes - blockVertices >= blockEdges,
+                  "Corrupt compressed graph!");
+      }
+
+      withWidth(vertexPtr, vertexWidth, [&](auto vertices) {
+        withWidth(edgePtr, edgeWidth, [&](auto edges) {
+          using VertexType = std::remove_pointer_t<decltype(vertices)>;
+          using EdgeType = std::remove_pointer_t<decltype(edges)>;
+
+          parallel_blocks(blocks, [&](uint64_t b) {
+            const uint8_t *ptr = bytes + index[b].byteOffset;
+            const uint8_t *end = bytes + index[b + 1].byteOffset;
+            uint64_t edge = index[b].edgeOffset;
+            uint64_t blockEnd = index[b + 1].edgeOffset;
+            uint64_t first = b * blockSize;
+            uint64_t last = std::min(vertex_count, first + blockSize);
+
+            for (uint64_t v = first; v < last; v++) {
+              uint64_t degree, prev = v;
+              ptr = getVarint(ptr, end, degree);
+              checkError(degree <= blockEnd - edge, "Corrupt compressed graph!");
+
+              vertices[v] = static_cast<VertexType>(edge);
+              for (; degree; degree--) {
+                uint64_t val;
+                ptr = getVarint(ptr, end, val);
+                prev = unzigzag(prev, val);
+                checkError(prev < vertex_count, "Corrupt compressed graph!");
+                edges[edge++] = static_cast<EdgeType>(prev);
+              }
+            }
+
+            checkError(ptr == end && edge == blockEnd, "Corrupt compressed graph!");
+          });
+
+          vertices[vertex_count] = static_cast<VertexType>(edge_count);
+        });
+      });
+    }
+
+    static std::pair<size_t,shared_array<uint32_t>>
+    decompress(shared_array<uint32_t> file, size_t fileSize)
+    {
+      auto header = static_cast<uint64_t*>(file);
+      bool undir = file[3];
+      uint64_t num_vertex = header[3];
+      uint64_t num_edge = header[4];
+      uint64_t blockSize = header[5];
+      uint64_t payload = header[6];
+      uint64_t rev_payload = header[7];
+
+      checkError(blockSize > 0, "Corrupt compressed graph!");
+      uint64_t blocks = (num_vertex + blockSize - 1) / blockSize;
+      size_t indexSize = (blocks + 1) * sizeof(BlockIndex);
+      size_t checkSize = compressedHeader + indexSize + payload;
+      if (!undir) checkSize += indexSize + rev_payload;
+
+      checkError(fileSize == checkSize,
+                  "Invalid file size! Wrong format? Expected: ", checkSize,
+                  " Found: ", fileSize);
+
+      size_t size = initSize(undir, num_vertex, num_edge);
+      void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+      if (reinterpret_cast<intptr_t>(ptr) == -1) {
+        perror("mmap");
+        dump_stack_trace(EXIT_FAILURE);
+      }
+
+      auto deleter = [=](void *data_ptr) { munmap(data_ptr, size); };
+      shared_array<uint32_t> data(ptr, deleter);
+
+      uint32_t vertexWidth = smallest_size(num_edge);
+      uint32_t edgeWidth = smallest_size(num_vertex);
+      data[0] = 1;
+      data[1] = 0;
+      data[2] = 0;
+      data[3] = undir;
+      data[4] = vertexWidth;
+      data[5] = edgeWidth;
+      static_cast<uint64_t*>(data)[3] = num_vertex;
+      static_cast<uint64_t*>(data)[4] = num_edge;
+
+      char *vertices = reinterpret_cast<char*>(&data[10]);
+      char *edges = vertices + (num_vertex + 1) * vertexWidth;
+      auto section = static_cast<const uint8_t*>(file) + compressedHeader;
+
+      decodeSection(section, payload, num_vertex, num_edge, blockSize,
+                    vertices, vertexWidth, edges, edgeWidth);
+
+      if (!undir) {
+        vertices = edges + num_edge * edgeWidth;
+        edges = vertices + (num_vertex + 1) * vertexWidth;
+        section += indexSize + payload;
+
+        decodeSection(section, rev_payload, num_vertex, num_edge, blockSize,
+                      vertices, vertexWidth, edges, edgeWidth);
+      }
+
+      return {size, data};
+    }
+
+    static std::pair<size_t,shared_array<uint32_t>>
+    loadFile(std::string fileName)
+    {
+      size_t fileSize = getFileSize(fileName);
+      auto data = getMmap(fileName, fileSize);
+
+      if (fileSize >= compressedHeader && detectVersion(data) == 2) {
+        return decompress(data, fileSize);
+      }
+      return {fileSize, data};
+    }
+
     static std::vector<Edge<E>>& empty_vector()
     {
         static auto& result = *new std::vector<Edge<E>>();
@@ -914,8 +1488,17 @@ class MutableGraph {
             template<bool SORTED>
             void sort_edges(typename std::enable_if<!SORTED>::type* = nullptr)
             {
-                sort(edges.begin(), edges.end());
-                sort(rev_edges.begin(), rev_edges.end());
+                sort_collection(edges);
+                sort_collection(rev_edges);
+            }
+
+            template<typename T>
+            void sort_collection(T& collection)
+            { std::sort(collection.begin(), collection.end()); }
+
+            void sort_collection(std::vector<Edge<E>>& collection)
+            {
+                radix_sort_edges(collection);
             }
 
             template<bool UNIQ>
@@ -955,28 +1538,60 @@ class MutableGraph {
         , Accessor<E>& edges
         , const C& edgeCollection)
     {
-        uint64_t vertex = 0, edgeOffset = 0;
-
         if (edgeCollection.empty()) return;
 
-        vertices[0] = edgeOffset;
-        for (auto&& edge : edgeCollection) {
-            while (vertex < edge.in) {
-               vertices[++vertex] = edgeOffset;
+        vertices.visit([&](auto vertexData) {
+          edges.visit([&](auto edgeData) {
+            using VertexType = std::remove_pointer_t<decltype(vertexData)>;
+            using EdgeType = std::remove_pointer_t<decltype(edgeData)>;
+            uint64_t vertex = 0, edgeOffset = 0;
+
+            vertexData[0] = 0;
+            for (auto&& edge : edgeCollection) {
+                checkError(edge.in < vertex_count && edge.out <= edges.maxVal
+                          && edgeOffset < edges.size,
+                          "Edge out of range! Edge: ", edge.in, " -> ",
+                          edge.out, " Vertex count: ", vertex_count);
+
+                while (vertex < edge.in) {
+                   vertexData[++vertex] = static_cast<VertexType>(edgeOffset);
+                }
+                edgeData[edgeOffset++] = static_cast<EdgeType>(edge.out);
             }
-            edges[edgeOffset++] = edge.out;
-        }
 
-        while (vertex < vertex_count) {
-            vertices[++vertex] = edgeOffset;
-        }
+            while (vertex < vertex_count) {
+                vertexData[++vertex] = static_cast<VertexType>(edgeOffset);
+            }
+          });
+        });
     }
 
   public:
-    MutableGraph(std::string file)
+    MutableGraph(std::string file) : MutableGraph(file, loadFile(file))
+    {}
+
+    // Memory used by the graph once loaded, the decoded size for compressed
+    // (version 2) files and the file size otherwise.
+    static size_t residentSize(const std::string& file)
+    {
+      uint64_t header[compressedHeader / sizeof(uint64_t)];
+      auto words = reinterpret_cast<const uint32_t*>(header);
+
+      std::ifstream input(file, std::ios::binary);
+      if (input.read(reinterpret_cast<char*>(header), sizeof header)
+          && words[0] == 2 && words[1] == 0 && words[2] == 0) {
+        return initSize(words[3], header[3], header[4]);
+      }
+      return getFileSize(file);
+    }
+
+  private:
+    MutableGraph
+      ( std::string file
+      , std::pair<size_t,shared_array<uint32_t>> mapping)
       : fileName(file)
-      , size(getFileSize(fileName))
-      , data(getMmap(fileName, size))
+      , size(mapping.first)
+      , data(mapping.second)
       , version(detectVersion(data))
       , undirected(data[version ? 3 : 0])
       , vertex_size(version ? data[4] : 4)
@@ -1061,6 +1676,7 @@ class MutableGraph {
         }
       }
 
+  public:
     MutableGraph
       ( std::string file
       , bool undir
@@ -1159,19 +1775,19 @@ class MutableGraph {
     ~MutableGraph() {}
 
     template<typename... Args>
-    static void output(Args... args)
+    static void output(Args&&... args)
     { output(makeGraphOutput<false,false>(args...)); }
 
     template<typename... Args>
-    static void outputUniq(Args... args)
+    static void outputUniq(Args&&... args)
     { output(makeGraphOutput<false,true>(args...)); }
 
     template<typename... Args>
-    static void outputSorted(Args... args)
+    static void outputSorted(Args&&... args)
     { output(makeGraphOutput<true,false>(args...)); }
 
     template<typename... Args>
-    static void outputSortedUniq(Args... args)
+    static void outputSortedUniq(Args&&... args)
     { output(makeGraphOutput<true,true>(args...)); }
 
     template<bool sorted, bool uniq, typename C, typename D>
@@ -1183,26 +1799,123 @@ class MutableGraph {
         writeEdges(out.vertex_count, graph.raw_rev_vertices, graph.raw_rev_edges, out.rev_edges);
     }
 
-    StatisticalSummary<double>
-    degreeStatistics(Degrees d) const
+    // Writes the graph in the compressed version 2 format.
+    void writeCompressed(const std::string& outFile) const
     {
-        std::vector<double> degrees;
-        degrees.reserve(vertex_count);
+      uint64_t blocks = (vertex_count + compressedBlock - 1) / compressedBlock;
+      std::vector<BlockIndex> index(blocks + 1), rev_index(blocks + 1);
+
+      uint64_t payload, rev_payload = 0;
+      payload = indexSection(raw_vertices, raw_edges, vertex_count, index);
+      if (!undirected) {
+        rev_payload = indexSection(raw_rev_vertices, raw_rev_edges,
+                                   vertex_count, rev_index);
+      }
 
-        for (auto v : vertices) {
-            size_t degree = 0;
+      size_t indexSize = (blocks + 1) * sizeof(BlockIndex);
+      size_t outSize = compressedHeader + indexSize + payload;
+      if (!undirected) outSize += indexSize + rev_payload;
+
+      auto out = initFile(outFile, outSize);
+      auto header = static_cast<uint64_t*>(out);
+      out[0] = 2;
+      out[1] = 0;
+      out[2] = 0;
+      out[3] = undirected;
+      out[4] = smallest_size(edge_count);
+      out[5] = smallest_size(vertex_count);
+      header[3] = vertex_count;
+      header[4] = edge_count;
+      header[5] = compressedBlock;
+      header[6] = payload;
+      header[7] = rev_payload;
+
+      auto section = static_cast<uint8_t*>(out) + compressedHeader;
+      encodeSection(raw_vertices, raw_edges, vertex_count, index, section);
+      if (!undirected) {
+        section += indexSize + payload;
+        encodeSection(raw_rev_vertices, raw_rev_edges, vertex_count,
+                      rev_index, section);
+      }
+    }
 
-            if (d == Degrees::out || d == Degrees::abs) {
-                degree += v.edges.size;
-            }
+    // Degree distributions for all of Degrees, computed in one parallel pass
+    // over the vertices unless cacheDir (if not empty) holds a valid cache.
+    DegreeProperties
+    degreeProperties(const std::string& cacheDir = std::string()) const
+    {
+        DegreeProperties result;
+        if (!cacheDir.empty() && result.load(fileName, cacheDir)
+            && result.vertex_count == vertex_count
+            && result.edge_count == edge_count) {
+            return result;
+        }
 
-            if (d == Degrees::in || (d == Degrees::abs && !undirected)) {
-                degree += v.rev_edges.size;
+        constexpr uint64_t denseDegrees = 4096;
+        constexpr uint64_t minChunk = 1 << 16;
+        struct Counts {
+            std::vector<uint64_t> dense;
+            std::vector<uint64_t> sparse;
+        };
+
+        uint64_t threads = std::max(1U, std::thread::hardware_concurrency());
+        uint64_t chunks = std::min(4 * threads, vertex_count / minChunk + 1);
+        std::vector<std::array<Counts,3>> partial(chunks);
+
+        raw_vertices.visit([&](auto verts) {
+          raw_rev_vertices.visit([&](auto rev_verts) {
+            parallel_blocks(chunks, [&](uint64_t c) {
+              for (auto& counts : partial[c]) counts.dense.resize(denseDegrees);
+
+              auto add = [&](Degrees d, uint64_t degree) {
+                Counts& counts = partial[c][static_cast<size_t>(d)];
+                if (degree < denseDegrees) counts.dense[degree]++;
+                else counts.sparse.push_back(degree);
+              };
+
+              uint64_t end = vertex_count / chunks * (c + 1)
+                           + std::min(c + 1, vertex_count % chunks);
+              uint64_t v = vertex_count / chunks * c
+                         + std::min(c, vertex_count % chunks);
+              for (; v < end; v++) {
+                uint64_t out = verts[v + 1] - verts[v];
+                uint64_t in = rev_verts[v + 1] - rev_verts[v];
+
+                add(Degrees::out, out);
+                add(Degrees::in, in);
+                add(Degrees::abs, undirected ? out : in + out);
+              }
+            });
+          });
+        });
+
+        for (auto d : { Degrees::in, Degrees::out, Degrees::abs }) {
+          size_t idx = static_cast<size_t>(d);
+          std::vector<uint64_t> dense(denseDegrees), sparse;
+          for (auto& counts : partial) {
+            auto& part = counts[idx];
+            for (uint64_t i = 0; i < denseDegrees; i++) dense[i] += part.dense[i];
+            sparse.insert(sparse.end(), part.sparse.begin(), part.sparse.end());
+            std::vector<uint64_t>().swap(part.sparse);
+          }
+          std::sort(sparse.begin(), sparse.end());
+
+          auto& hist = result.histogram(d);
+          for (uint64_t i = 0; i < denseDegrees; i++) {
+            if (dense[i]) hist.emplace_back(i, dense[i]);
+          }
+          for (auto degree : sparse) {
+            if (hist.empty() || hist.back().first != degree) {
+              hist.emplace_back(degree, 0);
             }
-
-            degrees.emplace_back(degree);
+            hist.back().second++;
+          }
         }
-        return StatisticalSummary<double>(std::move(degrees));
+
+        result.vertex_count = vertex_count;
+        result.edge_count = edge_count;
+        if (!cacheDir.empty()) result.save(fileName, cacheDir);
+        return result;
     }
 
     const bool undirected;
@@ -1221,4 +1934,27 @@ class MutableGraph {
 
 template<typename V, typename E>
 using Graph = const MutableGraph<V,E>;
+
+template<typename F>
+decltype(auto) dispatch_graph(const std::string& fileName, F&& f);
+
+// Opens a graph with the narrowest in-memory types its on-disk widths permit
+// and calls f with it. Files storing 32-bit offsets and vertex ids get
+// Graph<uint32_t,uint32_t>, everything else Graph<uint64_t,uint64_t>.
+template<typename F>
+decltype(auto) dispatch_graph(const std::string& fileName, F&& f)
+{
+    uint32_t header[6] = {};
+    std::ifstream file(fileName, std::ios::binary);
+    file.read(reinterpret_cast<char*>(header), sizeof header);
+
+    bool version0 = header[1] != 0 || header[2] != 0;
+    if (version0 || (header[4] == 4 && header[5] == 4)) {
+        Graph<uint32_t,uint32_t> graph(fileName);
+        return f(graph);
+    }
+
+    Graph<uint64_t,uint64_t> graph(fileName);
+    return f(graph);
+}
 #endif
@@ -0,0 +1,107 @@
+#ifndef GRAPHBUILDER_HPP
+#define GRAPHBUILDER_HPP
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "EdgeSorter.hpp"
+#include "Graph.hpp"
+
+// Out-of-core construction of graph files. Edges can be appended in any
+// order, they're sorted into runs within the memory budget (spilling to disk
+// beyond that) and merged straight into the mmapped output file by write.
+// For directed graphs the reverse edges are derived automatically, for
+// undirected graphs the caller is expected to supply both directions, just
+// like with MutableGraph::output.
+template<typename V, typename E>
+class GraphBuilder {
+    static constexpr size_t defaultBatch = 1 << 20;
+
+    const bool undirected;
+    const size_t batchSize;
+    EdgeSorter<E> edges;
+    EdgeSorter<E> rev_edges;
+
+    std::mutex lock;
+    uint64_t maxVertex;
+    bool hasEdges;
+    std::vector<Edge<E>> batch;
+
+    void updateMax(const std::vector<Edge<E>>& newEdges)
+    {
+      if (newEdges.empty()) return;
+
+      uint64_t result = 0;
+      for (auto& edge : newEdges) {
+        result = std::max<uint64_t>(result, std::max(edge.in, edge.out));
+      }
+
+      std::lock_guard<std::mutex> guard(lock);
+      maxVertex = hasEdges ? std::max(maxVertex, result) : result;
+      hasEdges = true;
+    }
+
+  public:
+    GraphBuilder
+        ( const std::string& spillPrefix, bool undirected_
+        , size_t memoryBudget, bool uniq = true)
+      : undirected(undirected_)
+      , batchSize(std::max<size_t>(1, std::min<size_t>(defaultBatch,
+                  memoryBudget / (4 * sizeof(Edge<E>)))))
+      , edges(spillPrefix + ".edges",
+              undirected ? memoryBudget : memoryBudget / 2, uniq)
+      , rev_edges(spillPrefix + ".rev_edges", memoryBudget / 2, uniq)
+      , maxVertex(0), hasEdges(false)
+    {}
+
+    GraphBuilder(const GraphBuilder&) = delete;
+    void operator=(const GraphBuilder&) = delete;
+
+    // Buffered, not thread-safe. Concurrent producers should use addEdges.
+    void emplace_back(E in, E out)
+    {
+      batch.emplace_back(in, out);
+      if (batch.size() >= batchSize) flush();
+    }
+
+    // Thread-safe.
+    void addEdges(std::vector<Edge<E>>&& newEdges)
+    {
+      updateMax(newEdges);
+
+      if (!undirected) {
+        std::vector<Edge<E>> reversed;
+        reversed.reserve(newEdges.size());
+        for (auto& edge : newEdges) reversed.emplace_back(edge.out, edge.in);
+        rev_edges.addRun(std::move(reversed));
+      }
+
+      edges.addRun(std::move(newEdges));
+    }
+
+    void flush()
+    {
+      addEdges(std::move(batch));
+      batch.clear();
+    }
+
+    // A vertex count of 0 means one more than the largest vertex id seen.
+    void write(const std::string& fileName, uint64_t vertexCount = 0)
+    {
+      flush();
+      if (vertexCount == 0 && hasEdges) vertexCount = maxVertex + 1;
+
+      if (undirected) {
+        std::vector<Edge<E>> none;
+        Graph<V,E>::outputSortedUniq(fileName, vertexCount, edges.count(),
+                                     edges, none);
+      } else {
+        rev_edges.finish();
+        Graph<V,E>::outputSortedUniq(fileName, vertexCount, edges.count(),
+                                     edges, rev_edges);
+      }
+    }
+};
+#endif
@@ -0,0 +1,163 @@
+#ifndef MD5_HPP
+#define MD5_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <streambuf>
+#include <string>
+
+// Incremental MD5 (RFC 1321), the digest benchmark-analysis uses to
+// identify algorithm outputs.
+class MD5 {
+    uint32_t state[4];
+    uint64_t length;
+    unsigned char block[64];
+    size_t used;
+
+    static uint32_t rotl(uint32_t x, int c)
+    { return (x << c) | (x >> (32 - c)); }
+
+    void transform(const unsigned char *data)
+    {
+        static const uint32_t K[64] = {
+            0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf,
+            0x4787c62a, 0xa8304613, 0xfd469501, 0x698098d8, 0x8b44f7af,
+            0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e,
+            0x49b40821, 0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa,
+            0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8, 0x21e1cde6,
+            0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8,
+            0x676f02d9, 0x8d2a4c8a, 0xfffa3942, 0x8771f681, 0x6d9d6122,
+            0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+            0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039,
+            0xe6db99e5, 0x1fa27cf8, 0xc4ac5665, 0xf4292244, 0x432aff97,
+            0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d,
+            0x85845dd1, 0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1,
+            0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391 };
+        static const int R[64] = {
+            7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+            5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20,
+            4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+            6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21 };
+
+        uint32_t M[16];
+        for (int i = 0; i < 16; i++) {
+            M[i] = static_cast<uint32_t>(data[4*i])
+                 | static_cast<uint32_t>(data[4*i + 1]) << 8
+                 | static_cast<uint32_t>(data[4*i + 2]) << 16
+                 | static_cast<uint32_t>(data[4*i + 3]) << 24;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        for (int i = 0; i < 64; i++) {
+            uint32_t f;
+            int g;
+            if (i < 16) {
+                f = (b & c) | (~b & d);
+                g = i;
+            } else if (i < 32) {
+                f = (d & b) | (~d & c);
+                g = (5 * i + 1) % 16;
+            } else if (i < 48) {
+                f = b ^ c ^ d;
+                g = (3 * i + 5) % 16;
+            } else {
+                f = c ^ (b | ~d);
+                g = (7 * i) % 16;
+            }
+
+            uint32_t tmp = d;
+            d = c;
+            c = b;
+            b = b + rotl(a + f + K[i] + M[g], R[i]);
+            a = tmp;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+    }
+
+  public:
+    MD5() : state{0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476}
+          , length(0), used(0)
+    {}
+
+    void update(const void *data, size_t size)
+    {
+        auto bytes = static_cast<const unsigned char*>(data);
+        length += size;
+
+        if (used) {
+            size_t n = std::min(size, sizeof block - used);
+            memcpy(block + used, bytes, n);
+            used += n;
+            bytes += n;
+            size -= n;
+            if (used < sizeof block) return;
+            transform(block);
+            used = 0;
+        }
+
+        for (; size >= sizeof block; bytes += sizeof block, size -= sizeof block) {
+            transform(bytes);
+        }
+
+        memcpy(block, bytes, size);
+        used = size;
+    }
+
+    std::string hexdigest()
+    {
+        uint64_t bits = length * 8;
+        unsigned char padding[64] = { 0x80 };
+        update(padding, 1 + (119 - used) % 64);
+
+        unsigned char size[8];
+        for (int i = 0; i < 8; i++) size[i] = static_cast<unsigned char>(bits >> (8 * i));
+        update(size, 8);
+
+        static const char hex[] = "0123456789abcdef";
+        std::string result;
+        for (auto word : state) {
+            for (int i = 0; i < 4; i++) {
+                auto byte = (word >> (8 * i)) & 0xff;
+                result += hex[byte >> 4];
+                result += hex[byte & 0xf];
+            }
+        }
+        return result;
+    }
+};
+
+// Stream buffer that hashes everything written through it, forwarding the
+// bytes to another stream buffer, if any.
+class MD5Streambuf : public std::streambuf {
+    std::streambuf *target;
+
+  protected:
+    std::streamsize xsputn(const char *data, std::streamsize count) override
+    {
+        digest.update(data, static_cast<size_t>(count));
+        return target ? target->sputn(data, count) : count;
+    }
+
+    int_type overflow(int_type c) override
+    {
+        if (traits_type::eq_int_type(c, traits_type::eof())) return 0;
+        char ch = traits_type::to_char_type(c);
+        digest.update(&ch, 1);
+        return target ? target->sputc(ch) : c;
+    }
+
+    int sync() override
+    { return target ? target->pubsync() : 0; }
+
+  public:
+    MD5Streambuf(std::streambuf *forward = nullptr) : target(forward)
+    {}
+
+    MD5 digest;
+};
+#endif
@@ -1,7 +1,11 @@
 #ifndef STATISTICALSUMMARY_HPP
 #define STATISTICALSUMMARY_HPP
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 template<typename T>
@@ -19,6 +23,8 @@ struct StatisticalSummary
     static double toDouble(const V& val)
     { return static_cast<double>(val); }
 
+    StatisticalSummary() {}
+
   public:
     template<typename V>
     StatisticalSummary(const std::vector<V>& values)
@@ -70,6 +76,63 @@ struct StatisticalSummary
         else stdDev = sqrt(S / (k-2));
     }
 
+    // Summary of a distribution given as (value, count) pairs in ascending
+    // value order, equivalent to expanding it into a vector of values.
+    template<typename V>
+    static StatisticalSummary
+    fromHistogram(const std::vector<std::pair<V,uint64_t>>& histogram)
+    {
+        uint64_t count = 0;
+        double total = 0;
+        for (auto& p : histogram) {
+            count += p.second;
+            total += toDouble<V>(p.first) * static_cast<double>(p.second);
+        }
+
+        if (count == 0) throw std::domain_error("Empty vector has no summary!");
+
+        std::pair<size_t,size_t> medianPair, lower, upper;
+        size_t half = count/2;
+        if (count > 1) {
+            medianPair = medianIndices(count);
+            lower = medianIndices(half);
+            upper = lower;
+
+            upper.first += half + (count % 2);
+            upper.second += half + (count % 2);
+        } else {
+            medianPair = lower = upper = {0, 0};
+        }
+
+        auto valueAt = [&](uint64_t idx) {
+            uint64_t seen = 0;
+            for (auto& p : histogram) {
+                seen += p.second;
+                if (idx < seen) return toDouble<V>(p.first);
+            }
+            return toDouble<V>(histogram.back().first);
+        };
+
+        StatisticalSummary result;
+        double mean = total / static_cast<double>(count);
+        result.mean = mean;
+
+        double S = 0.0;
+        for (auto& p : histogram) {
+            double diff = toDouble<V>(p.first) - mean;
+            S += diff * diff * static_cast<double>(p.second);
+        }
+
+        result.min = valueAt(0);
+        result.lowerQuantile = (valueAt(lower.first) + valueAt(lower.second))/2.0;
+        result.median = (valueAt(medianPair.first) + valueAt(medianPair.second))/2.0;
+        result.upperQuantile = (valueAt(upper.first) + valueAt(upper.second))/2.0;
+        result.max = valueAt(count - 1);
+        if (count == 1) result.stdDev = 0.0;
+        else result.stdDev = sqrt(S / static_cast<double>(count - 1));
+        return result;
+    }
+
     T min;
     T lowerQuantile;
     T median;
@@ -78,4 +141,134 @@ struct StatisticalSummary
     T max;
     T stdDev;
 };
+
+// Incrementally updated summary for unbounded sample streams. The first
+// exactLimit samples are kept, giving the same results as
+// StatisticalSummary. Beyond that, min, max, mean and standard deviation
+// remain exact (via Welford's algorithm), while quantiles come from a
+// log-linear histogram with 1/128 relative precision, in the style of an
+// HDR histogram. Summaries of the same type can be merged.
+template<typename T>
+class StreamingSummary
+{
+    static constexpr size_t exactLimit = 1024;
+    static constexpr int subBits = 7;
+    static constexpr uint64_t subBuckets = 1 << subBits;
+
+    uint64_t count;
+    double minVal, maxVal, M, S;
+    std::vector<double> samples;
+    std::vector<uint64_t> buckets;
+
+    static size_t bucketIndex(double value)
+    {
+        uint64_t v = value <= 0 ? 0 : static_cast<uint64_t>(std::llround(value));
+        if (v < subBuckets) return v;
+
+        int shift = 63 - __builtin_clzll(v) - subBits;
+        return static_cast<size_t>((static_cast<uint64_t>(shift) + 1) * subBuckets
+                                  + (v >> shift) - subBuckets);
+    }
+
+    static double bucketValue(size_t idx)
+    {
+        if (idx < subBuckets) return static_cast<double>(idx);
+
+        uint64_t shift = idx / subBuckets - 1;
+        uint64_t low = (idx % subBuckets + subBuckets) << shift;
+        return static_cast<double>(low) + static_cast<double>((1ULL << shift) - 1) / 2;
+    }
+
+    void addBucket(double value, uint64_t n)
+    {
+        size_t idx = bucketIndex(value);
+        if (idx >= buckets.size()) buckets.resize(idx + 1);
+        buckets[idx] += n;
+    }
+
+    void toHistogram()
+    {
+        for (auto val : samples) addBucket(val, 1);
+        std::vector<double>().swap(samples);
+    }
+
+    bool exact() const
+    { return count <= exactLimit; }
+
+  public:
+    StreamingSummary()
+      : count(0), minVal(0), maxVal(0), M(0), S(0)
+    {}
+
+    void reserve(size_t n)
+    { samples.reserve(std::min(exactLimit, n)); }
+
+    void add(double value)
+    {
+        count++;
+        if (count == 1 || value < minVal) minVal = value;
+        if (count == 1 || value > maxVal) maxVal = value;
+
+        double oldM = M;
+        M += (value - oldM) / static_cast<double>(count);
+        S += (value - oldM) * (value - M);
+
+        if (exact()) samples.push_back(value);
+        else if (samples.empty()) addBucket(value, 1);
+        else {
+          toHistogram();
+          addBucket(value, 1);
+        }
+    }
+
+    void merge(const StreamingSummary& other)
+    {
+        if (other.count == 0) return;
+        if (count + other.count <= exactLimit) {
+            for (auto val : other.samples) add(val);
+            return;
+        }
+
+        double total = static_cast<double>(count + other.count);
+        double delta = other.M - M;
+        S += other.S + delta * delta * static_cast<double>(count)
+                     * static_cast<double>(other.count) / total;
+        M += delta * static_cast<double>(other.count) / total;
+        minVal = count ? std::min(minVal, other.minVal) : other.minVal;
+        maxVal = count ? std::max(maxVal, other.maxVal) : other.maxVal;
+        count += other.count;
+
+        toHistogram();
+        for (auto val : other.samples) addBucket(val, 1);
+        if (buckets.size() < other.buckets.size()) {
+            buckets.resize(other.buckets.size());
+        }
+        for (size_t i = 0; i < other.buckets.size(); i++) {
+            buckets[i] += other.buckets[i];
+        }
+    }
+
+    size_t size() const
+    { return count; }
+
+    bool empty() const
+    { return count == 0; }
+
+    StatisticalSummary<T> summary() const
+    {
+        if (exact()) return StatisticalSummary<T>(samples);
+
+        std::vector<std::pair<double,uint64_t>> histogram;
+        for (size_t i = 0; i < buckets.size(); i++) {
+            if (buckets[i]) histogram.emplace_back(bucketValue(i), buckets[i]);
+        }
+
+        auto result = StatisticalSummary<T>::fromHistogram(histogram);
+        result.min = minVal;
+        result.mean = M;
+        result.max = maxVal;
+        result.stdDev = std::sqrt(S / static_cast<double>(count - 1));
+        return result;
+    }
+};
 #endif
@@ -7,12 +7,20 @@
 #include <cxxabi.h>
 #include <dlfcn.h>
 #include <execinfo.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #include <atomic>
+#include <functional>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
+#include <utility>
 
 #ifdef __clang__
 #define FALLTHROUGH [[clang::fallthrough]]
@@ -54,6 +62,44 @@ bool atomic_min(std::atomic<T>& min, T const& val) noexcept
 void __attribute__((noreturn)) out_of_memory(void);
 void __attribute__((noreturn)) dump_stack_trace(int exit_code);
 
+// Modification time of a file, including nanoseconds.
+inline struct timespec
+modification_time(const struct stat& statbuf)
+{
+#ifdef __APPLE__
+    return statbuf.st_mtimespec;
+#else
+    return statbuf.st_mtim;
+#endif
+}
+
+inline bool
+operator==(const struct timespec& a, const struct timespec& b)
+{ return a.tv_sec == b.tv_sec && a.tv_nsec == b.tv_nsec; }
+
+inline bool
+operator!=(const struct timespec& a, const struct timespec& b)
+{ return !(a == b); }
+
+// Starts a thread running f(args...) on any CPU the process may use. New
+// threads inherit the affinity of their creator, which would put every
+// worker on the single CPU the kernel runner pins its main thread to.
+template<typename F, typename... Args>
+std::thread
+unpinned_thread(F&& f, Args&&... args)
+{
+    return std::thread([](auto&& fun, auto&&... funArgs) {
+#ifdef __linux__
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        for (int i = 0; i < CPU_SETSIZE; i++) CPU_SET(i, &cpuset);
+        // CPUs outside the process' cpuset are ignored by the kernel.
+        pthread_setaffinity_np(pthread_self(), sizeof cpuset, &cpuset);
+#endif
+        std::invoke(fun, funArgs...);
+    }, std::forward<F>(f), std::forward<Args>(args)...);
+}
+
 void printVals(void);
 
 template<typename T, typename... Args>